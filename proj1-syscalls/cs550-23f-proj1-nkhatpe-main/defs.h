@@ -8,6 +8,7 @@ struct rtcdate;
 struct spinlock;
 struct sleeplock;
 struct stat;
+struct vdso;
 struct superblock;
 
 // bio.c
@@ -115,6 +116,7 @@ void            procdump(void);
 void            scheduler(void) __attribute__((noreturn));
 void            sched(void);
 void            setproc(struct proc*);
+int             settrace(int, uint);
 void            sleep(void*, struct spinlock*);
 void            userinit(void);
 int             wait(void);
@@ -155,6 +157,14 @@ int             argstr(int, char**);
 int             fetchint(uint, int*);
 int             fetchstr(uint, char**);
 void            syscall(void);
+void            syscount_read(uint*);
+void            syscount_hist(int, uint*);
+void            syscount_reset(void);
+
+// trace.c
+void            traceinit(void);
+void            tracesys(struct proc*, int, uint*, int, uint64);
+int             tracemap(pde_t*);
 
 // timer.c
 void            timerinit(void);
@@ -171,6 +181,7 @@ void            uartintr(void);
 void            uartputc(int);
 
 // vm.c
+extern struct vdso *vdso;
 void            seginit(void);
 void            kvmalloc(void);
 pde_t*          setupkvm(void);
@@ -185,6 +196,8 @@ void            switchuvm(struct proc*);
 void            switchkvm(void);
 int             copyout(pde_t*, uint, void*, uint);
 void            clearpteu(pde_t *pgdir, char *uva);
+int             mapuserpage(pde_t*, uint, char*, int);
+void            unmapuserpage(pde_t*, uint);
 
 // number of elements in fixed-size array
 #define NELEM(x) (sizeof(x)/sizeof((x)[0]))
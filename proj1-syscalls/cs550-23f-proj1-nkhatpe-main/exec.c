@@ -37,6 +37,8 @@ exec(char *path, char **argv)
 
   if((pgdir = setupkvm()) == 0)
     goto bad;
+  if(mapuserpage(pgdir, VPROCVA, (char*)curproc->vproc, PTE_U) < 0)
+    goto bad;
 
   // Load program into memory.
   sz = 0;
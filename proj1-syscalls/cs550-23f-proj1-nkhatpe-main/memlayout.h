@@ -8,6 +8,13 @@
 #define KERNBASE 0x80000000         // First kernel virtual address
 #define KERNLINK (KERNBASE+EXTMEM)  // Address where kernel is linked
 
+// Kernel pages that user processes can map read-only, just below KERNBASE.
+// User memory ends below them.
+#define TRACEVA  (KERNBASE-0x1000)  // syscall trace ring (trace.c)
+#define VDSOVA   (KERNBASE-0x2000)  // struct vdso, in every process (vdso.h)
+#define VPROCVA  (KERNBASE-0x3000)  // struct vproc, the process's own
+#define USERTOP  VPROCVA            // First address above user memory
+
 #define V2P(a) (((uint) (a)) - KERNBASE)
 #define P2V(a) (((void *) (a)) + KERNBASE)
 
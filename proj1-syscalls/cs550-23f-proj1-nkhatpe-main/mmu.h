@@ -39,6 +39,14 @@
 
 #define CR4_PSE         0x00000010      // Page size extension
 
+// CPUID leaf 1 %edx feature flags
+#define CPUID_SEP       0x00000800      // sysenter/sysexit
+
+// Model-specific registers for sysenter
+#define MSR_SYSENTER_CS  0x174          // Kernel %cs; %ss, user %cs and %ss follow it in the GDT
+#define MSR_SYSENTER_ESP 0x175          // Kernel %esp
+#define MSR_SYSENTER_EIP 0x176          // Kernel entry point
+
 // various segment selectors.
 #define SEG_KCODE 1  // kernel code
 #define SEG_KDATA 2  // kernel data+stack
@@ -0,0 +1,76 @@
+#include "types.h"
+#include "user.h"
+
+// Null system call benchmark: the cost of getpid() entered through
+// int $T_SYSCALL and through sysenter, and of reading the pid from
+// the vproc page with vgetpid() instead.
+//
+//   nullsys [calls]
+
+#define CALLS 100000
+
+static inline uint64 rdtsc(void)
+{
+    uint lo, hi;
+
+    asm volatile("rdtsc" : "=a" (lo), "=d" (hi));
+    return ((uint64)hi << 32) | lo;
+}
+
+// Cycles per call of getpid() made 'n' times, entering the kernel as
+// 'mode' says (see syscall_fast in user.h), or of vgetpid() if mode is 0.
+uint per_call(int mode, int n)
+{
+    uint64 start, cycles;
+    int i;
+
+    syscall_fast = mode;
+    start = rdtsc();
+    if (mode == 0) {
+        for (i = 0; i < n; i++) {
+            vgetpid();
+        }
+    } else {
+        for (i = 0; i < n; i++) {
+            getpid();
+        }
+    }
+    cycles = rdtsc() - start;
+
+    // No 64-bit division without libgcc.
+    while (cycles >> 32) {
+        cycles >>= 1;
+        n >>= 1;
+    }
+    return n > 0 ? (uint)cycles / n : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int n, fast;
+    uint trap, enter;
+
+    n = argc >= 2 ? atoi(argv[1]) : CALLS;
+    if (n <= 0) {
+        n = CALLS;
+    }
+
+    getpid(); // let the stubs probe for sysenter
+    fast = syscall_fast;
+
+    trap = per_call(-1, n);
+    printf(1, "int $T_SYSCALL: %d calls, %d cycles/call\n", n, trap);
+    printf(1, "vgetpid: %d calls, %d cycles/call\n", n, per_call(0, n));
+    syscall_fast = fast;
+    if (fast < 0) {
+        printf(1, "sysenter: not supported by this CPU\n");
+        exit();
+    }
+    enter = per_call(1, n);
+    printf(1, "sysenter: %d calls, %d cycles/call\n", n, enter);
+    if (enter > 0) {
+        printf(1, "sysenter is %d.%d times as fast\n", trap / enter, trap * 10 / enter % 10);
+    }
+
+    exit();
+}
@@ -11,4 +11,6 @@
 #define LOGSIZE      (MAXOPBLOCKS*3)  // max data blocks in on-disk log
 #define NBUF         (MAXOPBLOCKS*3)  // size of disk block cache
 #define FSSIZE       1000  // size of file system in blocks
+#define NSYSCALL     32  // size of the syscall count tables, > largest SYS_ number
+#define NSYSHIST     32  // log2 latency buckets per syscall: [2^i, 2^(i+1)) cycles
 
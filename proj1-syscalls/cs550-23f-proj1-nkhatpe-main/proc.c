@@ -6,6 +6,7 @@
 #include "x86.h"
 #include "proc.h"
 #include "spinlock.h"
+#include "vdso.h"
 
 struct {
   struct spinlock lock;
@@ -88,6 +89,7 @@ allocproc(void)
 found:
   p->state = EMBRYO;
   p->pid = nextpid++;
+  p->tracemask = 0;
 
   release(&ptable.lock);
 
@@ -96,6 +98,16 @@ found:
     p->state = UNUSED;
     return 0;
   }
+
+  // Allocate the page the process reads its own data from at VPROCVA.
+  if((p->vproc = (struct vproc*)kalloc()) == 0){
+    kfree(p->kstack);
+    p->kstack = 0;
+    p->state = UNUSED;
+    return 0;
+  }
+  memset(p->vproc, 0, PGSIZE);
+  p->vproc->pid = p->pid;
   sp = p->kstack + KSTACKSIZE;
 
   // Leave room for trap frame.
@@ -128,6 +140,8 @@ userinit(void)
   initproc = p;
   if((p->pgdir = setupkvm()) == 0)
     panic("userinit: out of memory?");
+  if(mapuserpage(p->pgdir, VPROCVA, (char*)p->vproc, PTE_U) < 0)
+    panic("userinit: out of memory?");
   inituvm(p->pgdir, _binary_initcode_start, (int)_binary_initcode_size);
   p->sz = PGSIZE;
   memset(p->tf, 0, sizeof(*p->tf));
@@ -189,8 +203,14 @@ fork(void)
     return -1;
   }
 
-  // Copy process state from proc.
-  if((np->pgdir = copyuvm(curproc->pgdir, curproc->sz)) == 0){
+  // Copy process state from proc; the child sees its own vproc page.
+  if((np->pgdir = copyuvm(curproc->pgdir, curproc->sz)) == 0 ||
+     mapuserpage(np->pgdir, VPROCVA, (char*)np->vproc, PTE_U) < 0){
+    if(np->pgdir)
+      freevm(np->pgdir);
+    np->pgdir = 0;
+    kfree((char*)np->vproc);
+    np->vproc = 0;
     kfree(np->kstack);
     np->kstack = 0;
     np->state = UNUSED;
@@ -210,6 +230,9 @@ fork(void)
 
   safestrcpy(np->name, curproc->name, sizeof(curproc->name));
 
+  // Children of a traced process are traced too.
+  np->tracemask = curproc->tracemask;
+
   pid = np->pid;
 
   acquire(&ptable.lock);
@@ -290,6 +313,8 @@ wait(void)
         kfree(p->kstack);
         p->kstack = 0;
         freevm(p->pgdir);
+        kfree((char*)p->vproc);
+        p->vproc = 0;
         p->pid = 0;
         p->parent = 0;
         p->name[0] = 0;
@@ -504,6 +529,26 @@ kill(int pid)
   return -1;
 }
 
+// Trace the system calls of process pid whose bits are set in mask,
+// and of the children it forks from now on. A mask of 0 stops tracing.
+// Returns -1 if there is no such live process.
+int
+settrace(int pid, uint mask)
+{
+  struct proc *p;
+
+  acquire(&ptable.lock);
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+    if(p->pid == pid && p->state != UNUSED && p->state != ZOMBIE){
+      p->tracemask = mask;
+      release(&ptable.lock);
+      return 0;
+    }
+  }
+  release(&ptable.lock);
+  return -1;
+}
+
 //PAGEBREAK: 36
 // Print a process listing to console.  For debugging.
 // Runs when user types ^P on console.
@@ -8,6 +8,8 @@ struct cpu {
   int ncli;                    // Depth of pushcli nesting.
   int intena;                  // Were interrupts enabled before pushcli?
   struct proc *proc;           // The process running on this cpu or null
+  uint syshist[NSYSCALL][NSYSHIST]; // System call latencies in rdtsc cycles, log2
+                               // buckets; counts and epoch are in vdso->cpu[]
 };
 
 extern struct cpu cpus[NCPU];
@@ -49,6 +51,8 @@ struct proc {
   struct file *ofile[NOFILE];  // Open files
   struct inode *cwd;           // Current directory
   char name[16];               // Process name (debugging)
+  uint tracemask;              // System calls to trace, bit n for call n
+  struct vproc *vproc;         // Read-only to the process at VPROCVA
 };
 
 // Process memory is laid out contiguously, low addresses first:
@@ -0,0 +1,106 @@
+#include "types.h"
+#include "param.h"
+#include "syscall.h"
+#include "tracering.h"
+#include "user.h"
+#include "sysnames.h"
+
+// Run a command and print every system call it and its children make:
+//
+//   strace command [args...]
+//
+// The kernel writes the calls into the trace ring, which strace maps
+// read-only and drains once a tick. Records the ring overwrote before
+// they were read are counted and reported at the end.
+
+struct tracering *ring;
+struct tracerec batch[NTRACEREC];
+uint seen;     // records consumed so far
+uint dropped;  // records overwritten before they were consumed
+
+// Print the records written since the last call.
+void drain(void)
+{
+    uint head, first, n, i;
+    struct tracerec *r;
+
+    // The kernel may be writing the record at head already, and that slot
+    // also holds record head - NTRACEREC, so only NTRACEREC - 1 are safe.
+    head = ring->head;
+    first = seen;
+    if (head - first >= NTRACEREC)
+    {
+        dropped += head - first - (NTRACEREC - 1);
+        first = head - (NTRACEREC - 1);
+    }
+    n = head - first;
+    for (i = 0; i < n; i++)
+    {
+        batch[i] = ring->rec[(first + i) % NTRACEREC];
+    }
+    __sync_synchronize();
+
+    // Anything the kernel got round to overwriting while we copied is lost.
+    head = ring->head;
+    for (i = 0; i < n; i++)
+    {
+        if (head - (first + i) >= NTRACEREC)
+        {
+            dropped++;
+            continue;
+        }
+        r = &batch[i];
+        printf(1, "[%d] %s(%d, %d, %d) = %d, %d cycles\n", r->pid,
+               r->num < NSYSCALL && sysnames[r->num] ? sysnames[r->num] : "?",
+               r->arg[0], r->arg[1], r->arg[2], r->ret, r->cycles);
+    }
+    seen = first + n;
+}
+
+int main(int argc, char *argv[])
+{
+    int pid;
+
+    if (argc < 2)
+    {
+        printf(2, "Usage: %s command [args...]\n", argv[0]);
+        exit();
+    }
+
+    ring = tracemap();
+    if ((int)ring == -1)
+    {
+        printf(2, "tracemap failed\n");
+        exit();
+    }
+    seen = ring->head;
+
+    pid = fork();
+    if (pid < 0)
+    {
+        printf(2, "fork failed\n");
+        exit();
+    }
+    if (pid == 0)
+    {
+        trace(getpid(), ~0);
+        exec(argv[1], argv + 1);
+        printf(2, "exec %s failed\n", argv[1]);
+        exit();
+    }
+
+    // trace() fails once the child has exited; drain what it left behind.
+    while (trace(pid, ~0) == 0)
+    {
+        drain();
+        sleep(1);
+    }
+    drain();
+    wait();
+
+    if (dropped > 0)
+    {
+        printf(1, "%d records dropped\n", dropped);
+    }
+    exit();
+}
@@ -6,6 +6,7 @@
 #include "proc.h"
 #include "x86.h"
 #include "syscall.h"
+#include "vdso.h"
 
 // User code makes a system call with INT T_SYSCALL.
 // System call number in %eax.
@@ -109,6 +110,10 @@ extern int sys_uptime(void);
 extern int sys_shutdown(void);
 extern int sys_get_syscall_count(void);
 extern int sys_reset_syscall_count(void);
+extern int sys_get_syscall_counts(void);
+extern int sys_get_syscall_hist(void);
+extern int sys_trace(void);
+extern int sys_tracemap(void);
 
 static int (*syscalls[])(void) = {
 [SYS_fork]    sys_fork,
@@ -135,17 +140,132 @@ static int (*syscalls[])(void) = {
 [SYS_shutdown]      sys_shutdown,
 [SYS_get_syscall_count] sys_get_syscall_count,
 [SYS_reset_syscall_count] sys_reset_syscall_count,
+[SYS_get_syscall_counts] sys_get_syscall_counts,
+[SYS_get_syscall_hist] sys_get_syscall_hist,
+[SYS_trace]   sys_trace,
+[SYS_tracemap] sys_tracemap,
 };
 
+// Each cpu counts the system calls made on it in its own table, and
+// keeps a log2 histogram of their latencies, so accounting takes no
+// lock and no shared cache line. The count tables live in the vdso
+// page, where user space can read them too. A reset bumps
+// vdso->epoch; a cpu whose tables are from an older epoch clears them
+// before it next updates them, and readers treat them as all zeroes
+// until then. That makes the reset atomic for readers without
+// stopping the other cpus.
+
+// Return this cpu, with its tables current. Call with interrupts off.
+static struct cpu*
+syscount_cpu(void)
+{
+  struct cpu *c;
+  struct vdsocpu *v;
+
+  c = mycpu();
+  v = &vdso->cpu[c-cpus];
+  if(v->epoch != vdso->epoch){
+    memset((void*)v->count, 0, sizeof(v->count));
+    memset(c->syshist, 0, sizeof(c->syshist));
+    v->epoch = vdso->epoch;
+  }
+  return c;
+}
+
+static void
+syscount_inc(int num)
+{
+  pushcli();
+  vdso->cpu[syscount_cpu()-cpus].count[num]++;
+  popcli();
+}
+
+// Record a call to num that took 'cycles', in the histogram of the cpu
+// it finished on.
+static void
+syscount_time(int num, uint64 cycles)
+{
+  uint d;
+  int b;
+
+  d = cycles >> 32 ? 0xffffffff : (uint)cycles;
+  for(b = 0; d > 1; d >>= 1)
+    b++;
+  pushcli();
+  syscount_cpu()->syshist[num][b]++;
+  popcli();
+}
+
+// Sum the per-cpu tables into counts[NSYSCALL].
+void
+syscount_read(uint *counts)
+{
+  struct cpu *c;
+  uint epoch;
+  int i;
+
+  memset(counts, 0, NSYSCALL * sizeof(uint));
+  epoch = vdso->epoch;
+  for(c = cpus; c < cpus+ncpu; c++){
+    if(vdso->cpu[c-cpus].epoch != epoch)
+      continue;
+    for(i = 0; i < NSYSCALL; i++)
+      counts[i] += vdso->cpu[c-cpus].count[i];
+  }
+}
+
+// Sum the per-cpu latency histograms of num into hist[NSYSHIST].
+void
+syscount_hist(int num, uint *hist)
+{
+  struct cpu *c;
+  uint epoch;
+  int i;
+
+  memset(hist, 0, NSYSHIST * sizeof(uint));
+  epoch = vdso->epoch;
+  for(c = cpus; c < cpus+ncpu; c++){
+    if(vdso->cpu[c-cpus].epoch != epoch)
+      continue;
+    for(i = 0; i < NSYSHIST; i++)
+      hist[i] += c->syshist[num][i];
+  }
+}
+
+void
+syscount_reset(void)
+{
+  __sync_fetch_and_add(&vdso->epoch, 1);
+}
+
 void
 syscall(void)
 {
-  int num;
+  int num, i, traced;
+  uint arg[3];
+  uint64 start, cycles;
   struct proc *curproc = myproc();
 
   num = curproc->tf->eax;
   if(num > 0 && num < NELEM(syscalls) && syscalls[num]) {
+    syscount_inc(num);
+    // Take the arguments of a traced call now, before exec replaces
+    // the stack they are on. exit does not return, so it is traced
+    // on the way in.
+    traced = (curproc->tracemask >> num) & 1;
+    if(traced){
+      for(i = 0; i < 3; i++)
+        if(argint(i, (int*)&arg[i]) < 0)
+          arg[i] = 0;
+      if(num == SYS_exit)
+        tracesys(curproc, num, arg, 0, 0);
+    }
+    start = rdtsc();
     curproc->tf->eax = syscalls[num]();
+    cycles = rdtsc() - start;
+    syscount_time(num, cycles);
+    if(traced)
+      tracesys(curproc, num, arg, curproc->tf->eax, cycles);
   } else {
     cprintf("%d %s: unknown sys call %d\n",
             curproc->pid, curproc->name, num);
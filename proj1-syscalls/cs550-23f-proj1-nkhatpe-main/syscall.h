@@ -23,3 +23,7 @@
 #define SYS_shutdown     22
 #define SYS_get_syscall_count 23
 #define SYS_reset_syscall_count 24
+#define SYS_get_syscall_counts 25
+#define SYS_get_syscall_hist 26
+#define SYS_trace  27
+#define SYS_tracemap 28
@@ -0,0 +1,92 @@
+#include "types.h"
+#include "param.h"
+#include "syscall.h"
+#include "user.h"
+#include "sysnames.h"
+
+// Run a command and print, for every system call it made, how many
+// calls there were and the p50/p99 latency in rdtsc cycles:
+//
+//   syscallstat command [args...]
+//
+// Latencies come from log2 buckets, so a percentile is printed as the
+// upper bound of the bucket it falls in. Calls that block (wait, read,
+// sleep) include the time spent asleep; exit never returns, so it has
+// a count but no latency. The counts include syscallstat's own fork
+// and wait.
+
+// Return the bucket holding the call ranked 'pct' percent of 'total'.
+int percentile(uint *hist, uint total, int pct)
+{
+    uint rank, seen;
+    int i;
+
+    rank = (total * pct + 99) / 100;
+    if (rank == 0)
+        rank = 1;
+    seen = 0;
+    for (i = 0; i < NSYSHIST; i++) {
+        seen += hist[i];
+        if (seen >= rank)
+            return i;
+    }
+    return NSYSHIST - 1;
+}
+
+// Print the upper bound of bucket b, 2^(b+1) cycles.
+void print_bound(int b)
+{
+    if (b + 1 >= 31)
+        printf(1, "2^%d", b + 1);
+    else
+        printf(1, "%d", 1 << (b + 1));
+}
+
+int main(int argc, char *argv[])
+{
+    uint counts[NSYSCALL];
+    uint hist[NSYSHIST];
+    uint timed;
+    int pid, num, i;
+
+    if (argc < 2) {
+        printf(2, "Usage: %s command [args...]\n", argv[0]);
+        exit();
+    }
+
+    reset_syscall_count();
+    pid = fork();
+    if (pid < 0) {
+        printf(2, "fork failed\n");
+        exit();
+    }
+    if (pid == 0) {
+        exec(argv[1], argv + 1);
+        printf(2, "exec %s failed\n", argv[1]);
+        exit();
+    }
+    wait();
+
+    // Counts are copied first so the lookups below do not count themselves.
+    get_syscall_counts(counts, NSYSCALL);
+
+    for (num = 1; num < NSYSCALL; num++) {
+        if (counts[num] == 0)
+            continue;
+        get_syscall_hist(num, hist);
+        timed = 0;
+        for (i = 0; i < NSYSHIST; i++)
+            timed += hist[i];
+        printf(1, "%s (%d): %d calls", sysnames[num] ? sysnames[num] : "?", num, counts[num]);
+        if (timed > 0) {
+            printf(1, ", p50 <");
+            print_bound(percentile(hist, timed, 50));
+            printf(1, ", p99 <");
+            print_bound(percentile(hist, timed, 99));
+            printf(1, " cycles");
+        }
+        printf(1, "\n");
+    }
+
+    exit();
+}
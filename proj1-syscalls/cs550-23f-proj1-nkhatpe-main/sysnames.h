@@ -0,0 +1,33 @@
+// Names of the system calls, indexed by number, for user programs
+// that print them. Include after param.h and syscall.h.
+
+static char *sysnames[NSYSCALL] = {
+[SYS_fork]    "fork",
+[SYS_exit]    "exit",
+[SYS_wait]    "wait",
+[SYS_pipe]    "pipe",
+[SYS_read]    "read",
+[SYS_kill]    "kill",
+[SYS_exec]    "exec",
+[SYS_fstat]   "fstat",
+[SYS_chdir]   "chdir",
+[SYS_dup]     "dup",
+[SYS_getpid]  "getpid",
+[SYS_sbrk]    "sbrk",
+[SYS_sleep]   "sleep",
+[SYS_uptime]  "uptime",
+[SYS_open]    "open",
+[SYS_write]   "write",
+[SYS_mknod]   "mknod",
+[SYS_unlink]  "unlink",
+[SYS_link]    "link",
+[SYS_mkdir]   "mkdir",
+[SYS_close]   "close",
+[SYS_shutdown] "shutdown",
+[SYS_get_syscall_count] "get_syscall_count",
+[SYS_reset_syscall_count] "reset_syscall_count",
+[SYS_get_syscall_counts] "get_syscall_counts",
+[SYS_get_syscall_hist] "get_syscall_hist",
+[SYS_trace]   "trace",
+[SYS_tracemap] "tracemap",
+};
@@ -7,23 +7,17 @@
 #include "mmu.h"
 #include "proc.h"
 
-// Declare global invocation counters for system calls
-int syscall_fork_count = 0;
-int syscall_wait_count = 0;
-int syscall_exit_count = 0;
-
+#include "syscall.h"
 
 int
 sys_fork(void)
 {
-  syscall_fork_count++;	
   return fork();
 }
 
 int
 sys_exit(void)
 {
-  syscall_exit_count++;
   exit();
   return 0;  // not reached
 }
@@ -31,7 +25,6 @@ sys_exit(void)
 int
 sys_wait(void)
 {
-  syscall_wait_count++;
   return wait();
 }
 
@@ -109,37 +102,72 @@ int sys_shutdown(void)
 }
 
 int sys_get_syscall_count(void) {
+    static int nums[] = { SYS_fork, SYS_wait, SYS_exit };
+    uint counts[NSYSCALL];
     int call_type;
 
     if (argint(0, &call_type) < 0)
         return -1;
+    if (call_type < 0 || call_type >= NELEM(nums))
+        return -1; // Invalid call type
 
-    switch (call_type) {
-        case 0: // fork()
-            cprintf("Getting fork count: %d\n", syscall_fork_count);
-            return syscall_fork_count;
-        case 1: // wait()
-            cprintf("Getting wait count: %d\n", syscall_wait_count);
-            return syscall_wait_count;
-        case 2: // exit()
-            cprintf("Getting exit count: %d\n", syscall_exit_count);
-            return syscall_exit_count;
-        default:
-            return -1; // Invalid call type
-    }
+    // 0 is fork(), 1 is wait() and 2 is exit().
+    syscount_read(counts);
+    return counts[nums[call_type]];
 }
 
 int sys_reset_syscall_count(void) {
-    syscall_fork_count = 0;
-    syscall_wait_count = 0;
-    syscall_exit_count = 0;
-    cprintf("Resetting syscall counts to zero.\n");
+    syscount_reset();
+    return 0;
+}
+
+// Copy the count of every system call, indexed by number, to the user
+// array 'counts' of 'n' entries. Returns the number of entries copied.
+int sys_get_syscall_counts(void) {
+    uint counts[NSYSCALL];
+    char *buf;
+    int n;
 
-    // Add debugging message to check the counts after the reset
-    cprintf("Counts after reset: fork=%d, wait=%d, exit=%d\n", syscall_fork_count, syscall_wait_count, syscall_exit_count);
+    if (argint(1, &n) < 0 || n < 0)
+        return -1;
+    if (n > NSYSCALL)
+        n = NSYSCALL;
+    if (argptr(0, &buf, n * sizeof(uint)) < 0)
+        return -1;
+
+    syscount_read(counts);
+    memmove(buf, counts, n * sizeof(uint));
+    return n;
+}
 
+// Copy the latency histogram of system call 'num' to the user array
+// 'hist' of NSYSHIST entries: hist[i] calls took [2^i, 2^(i+1)) cycles.
+int sys_get_syscall_hist(void) {
+    char *buf;
+    int num;
+
+    if (argint(0, &num) < 0 || num < 0 || num >= NSYSCALL)
+        return -1;
+    if (argptr(1, &buf, NSYSHIST * sizeof(uint)) < 0)
+        return -1;
+
+    syscount_hist(num, (uint*)buf);
     return 0;
 }
 
+// Trace the system calls in 'mask' (bit n for call n) made by process
+// 'pid' and the children it forks; a mask of 0 stops tracing.
+int sys_trace(void) {
+    int pid, mask;
 
+    if (argint(0, &pid) < 0 || argint(1, &mask) < 0)
+        return -1;
+
+    return settrace(pid, mask);
+}
 
+// Map the trace ring read-only into the calling process and return
+// its address; see tracering.h for how to read it.
+int sys_tracemap(void) {
+    return tracemap(myproc()->pgdir);
+}
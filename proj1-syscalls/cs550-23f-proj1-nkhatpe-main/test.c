@@ -1,4 +1,6 @@
 #include "types.h"
+#include "param.h"
+#include "syscall.h"
 #include "user.h"
 
 // Function to test syscall counts with a specified loop count
@@ -31,6 +33,26 @@ void test_loop(int loop) {
     printf(1, "Actual result: fork[%d] wait[%d] exit[%d]\n", fork_count, wait_count, exit_count);
 }
 
+// Function to test the whole syscall count table with a specified loop count
+void test_table(int loop) {
+    uint counts[NSYSCALL];
+    int n;
+
+    reset_syscall_count();
+    for (int i = 0; i < loop; i++) {
+        getpid();
+        uptime();
+    }
+    n = get_syscall_counts(counts, NSYSCALL);
+
+    // The reset itself is not counted; get_syscall_counts() counts itself.
+    printf(1, "Expected result: entries[%d] getpid[%d] uptime[%d] get_syscall_counts[1]\n", NSYSCALL, loop, loop);
+    printf(1, "Actual result: entries[%d] getpid[%d] uptime[%d] get_syscall_counts[%d]\n",
+           n, counts[SYS_getpid], counts[SYS_uptime], counts[SYS_get_syscall_counts]);
+    printf(1, "Read without a syscall: getpid[%d] uptime[%d] pid[%d/%d]\n",
+           vsyscall_count(SYS_getpid), vsyscall_count(SYS_uptime), vgetpid(), getpid());
+}
+
 int main(int argc, char *argv[]) {
     printf(1, ">>> Test 1:\n");
     test_loop(5); // Test with a loop count of 5
@@ -38,6 +60,9 @@ int main(int argc, char *argv[]) {
     printf(1, ">>> Test 2:\n");
     test_loop(10); // Test with a loop count of 10
     
+    printf(1, ">>> Test 3:\n");
+    test_table(100); // Test the whole table with a loop count of 100
+
     // Add more tests with different loop counts if needed
     
     exit();
@@ -0,0 +1,61 @@
+// Syscall tracing.
+//
+// syscall() calls tracesys() for every call made by a process whose
+// tracemask has the call's bit set. The records go into a single ring
+// page (see tracering.h) that a consumer maps read-only with tracemap()
+// and drains in batches, instead of the kernel printing each call.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "proc.h"
+#include "x86.h"
+#include "spinlock.h"
+#include "tracering.h"
+
+static struct {
+  struct spinlock lock;  // Serializes writers; readers take no lock
+  struct tracering *ring;
+} trace;
+
+void
+traceinit(void)
+{
+  initlock(&trace.lock, "trace");
+  if((trace.ring = (struct tracering*)kalloc()) == 0)
+    panic("traceinit");
+  memset(trace.ring, 0, PGSIZE);
+  trace.ring->nrec = NTRACEREC;
+}
+
+// Append a record for call num by p.
+void
+tracesys(struct proc *p, int num, uint *arg, int ret, uint64 cycles)
+{
+  struct tracerec *r;
+
+  acquire(&trace.lock);
+  r = &trace.ring->rec[trace.ring->head % NTRACEREC];
+  r->pid = p->pid;
+  r->num = num;
+  r->arg[0] = arg[0];
+  r->arg[1] = arg[1];
+  r->arg[2] = arg[2];
+  r->ret = ret;
+  r->cycles = cycles >> 32 ? 0xffffffff : (uint)cycles;
+  // Publish the record before the head that covers it.
+  __sync_synchronize();
+  trace.ring->head++;
+  release(&trace.lock);
+}
+
+// Map the ring read-only at TRACEVA in pgdir and return its address.
+int
+tracemap(pde_t *pgdir)
+{
+  if(mapuserpage(pgdir, TRACEVA, (char*)trace.ring, PTE_U) < 0)
+    return -1;
+  return TRACEVA;
+}
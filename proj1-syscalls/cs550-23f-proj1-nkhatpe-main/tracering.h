@@ -0,0 +1,26 @@
+// Syscall trace ring, shared read-only with user space by tracemap().
+//
+// The kernel appends a record for each system call made by a process
+// traced with trace(pid, mask) and then advances head, the number of
+// records ever written. Record i lives in rec[i % NTRACEREC], so the
+// ring keeps the last NTRACEREC records and overwrites older ones.
+// A reader keeps its own count of records consumed, copies the ones
+// below head, and then re-reads head: any record it copied that is
+// older than the new head - NTRACEREC may have been overwritten while
+// it was copying and must be dropped.
+
+struct tracerec {
+  ushort pid;        // Process that made the call
+  ushort num;        // System call number
+  uint arg[3];       // First three arguments, as ints
+  int ret;           // Return value (0 for exit, which does not return)
+  uint cycles;       // rdtsc cycles spent in the call
+};
+
+#define NTRACEREC ((4096 - 2*sizeof(uint)) / sizeof(struct tracerec))
+
+struct tracering {
+  volatile uint head;  // Records written so far
+  uint nrec;           // NTRACEREC
+  struct tracerec rec[NTRACEREC];
+};
@@ -1,8 +1,11 @@
 #include "types.h"
+#include "param.h"
+#include "memlayout.h"
 #include "stat.h"
 #include "fcntl.h"
 #include "user.h"
 #include "x86.h"
+#include "vdso.h"
 
 char*
 strcpy(char *s, char *t)
@@ -103,3 +106,47 @@ memmove(void *vdst, void *vsrc, int n)
     *dst++ = *src++;
   return vdst;
 }
+
+// Read kernel data from the pages the kernel maps into every process
+// (see vdso.h), without a system call.
+
+// Like uptime().
+uint
+vuptime(void)
+{
+  return ((struct vdso*)VDSOVA)->ticks;
+}
+
+// Like getpid().
+int
+vgetpid(void)
+{
+  return ((struct vproc*)VPROCVA)->pid;
+}
+
+// Free physical pages.
+uint
+vfreepages(void)
+{
+  return ((struct vdso*)VDSOVA)->nfree;
+}
+
+// Calls to system call num since the last reset_syscall_count(),
+// summed over the cpus the way the kernel does.
+uint
+vsyscall_count(int num)
+{
+  struct vdso *v;
+  uint epoch, n;
+  int i;
+
+  if(num < 0 || num >= NSYSCALL)
+    return 0;
+  v = (struct vdso*)VDSOVA;
+  epoch = v->epoch;
+  n = 0;
+  for(i = 0; i < NCPU; i++)
+    if(v->cpu[i].epoch == epoch)
+      n += v->cpu[i].count[num];
+  return n;
+}
@@ -1,5 +1,6 @@
 struct stat;
 struct rtcdate;
+struct tracering;
 
 // system calls
 int fork(void);
@@ -26,6 +27,13 @@ int uptime(void);
 void shutdown(void);
 int get_syscall_count(int call_type);
 int reset_syscall_count(void);
+int get_syscall_counts(uint *counts, int n);
+int get_syscall_hist(int num, uint *hist);
+int trace(int pid, int mask);
+struct tracering* tracemap(void);
+
+// usys.S
+extern int syscall_fast;  // 1: enter the kernel with sysenter, -1: with int $T_SYSCALL
 
 // ulib.c
 int stat(char*, struct stat*);
@@ -40,3 +48,7 @@ void* memset(void*, int, uint);
 void* malloc(uint);
 void free(void*);
 int atoi(const char*);
+uint vuptime(void);
+int vgetpid(void);
+uint vfreepages(void);
+uint vsyscall_count(int);
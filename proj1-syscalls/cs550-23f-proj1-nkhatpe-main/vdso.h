@@ -0,0 +1,24 @@
+// Kernel data that every process can read without a system call.
+//
+// The kernel maps a struct vdso shared by all processes read-only at
+// VDSOVA, and a struct vproc of each process's own read-only at
+// VPROCVA (see memlayout.h). The helpers in ulib.c read them.
+
+// A cpu's system call counts (see syscall.c). They belong to the
+// current count only if epoch matches the epoch in struct vdso; a
+// reset bumps that, and each cpu clears its table when it next counts.
+struct vdsocpu {
+  volatile uint epoch;
+  volatile uint count[NSYSCALL];  // Calls by number
+};
+
+struct vdso {
+  volatile uint ticks;          // Timer ticks since boot, as uptime()
+  volatile uint nfree;          // Free physical pages
+  volatile uint epoch;          // System call count epoch
+  struct vdsocpu cpu[NCPU];     // Unused cpus never count, so read as 0
+};
+
+struct vproc {
+  int pid;                      // As getpid()
+};
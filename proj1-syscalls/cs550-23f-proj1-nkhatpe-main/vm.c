@@ -6,16 +6,31 @@
 #include "mmu.h"
 #include "proc.h"
 #include "elf.h"
+#include "vdso.h"
 
 extern char data[];  // defined by kernel.ld
+extern char sysentry[];  // trapasm.S
 pde_t *kpgdir;  // for use in scheduler()
 
+// Set if the CPUs have sysenter/sysexit. The kernel stack that sysenter
+// switches to is per process, so switchuvm() updates it on every switch.
+static int sysenter;
+
+// The page every process can read at VDSOVA (see vdso.h). It has a
+// page to itself so that no other kernel data shows through.
+static union {
+  struct vdso v;
+  char page[PGSIZE];
+} vdsopage __attribute__((aligned(PGSIZE)));
+struct vdso *vdso = &vdsopage.v;
+
 // Set up CPU's kernel segment descriptors.
 // Run once on entry on each CPU.
 void
 seginit(void)
 {
   struct cpu *c;
+  uint edx;
 
   // Map "logical" addresses to virtual addresses using identity map.
   // Cannot share a CODE descriptor for both kernel and user
@@ -27,6 +42,16 @@ seginit(void)
   c->gdt[SEG_UCODE] = SEG(STA_X|STA_R, 0, 0xffffffff, DPL_USER);
   c->gdt[SEG_UDATA] = SEG(STA_W, 0, 0xffffffff, DPL_USER);
   lgdt(c->gdt, sizeof(c->gdt));
+
+  // Fast system calls. sysenter takes the kernel %ss and sysexit the
+  // user %cs and %ss from the descriptors after SEG_KCODE, which is
+  // the order they have above.
+  cpuinfo(1, 0, 0, 0, &edx);
+  if(edx & CPUID_SEP){
+    wrmsr(MSR_SYSENTER_CS, SEG_KCODE<<3);
+    wrmsr(MSR_SYSENTER_EIP, (uint)sysentry);
+    sysenter = 1;
+  }
 }
 
 // Return the address of the PTE in page table pgdir
@@ -132,6 +157,10 @@ setupkvm(void)
       freevm(pgdir);
       return 0;
     }
+  if(mapuserpage(pgdir, VDSOVA, (char*)vdso, PTE_U) < 0){
+    freevm(pgdir);
+    return 0;
+  }
   return pgdir;
 }
 
@@ -173,6 +202,8 @@ switchuvm(struct proc *p)
   // forbids I/O instructions (e.g., inb and outb) from user space
   mycpu()->ts.iomb = (ushort) 0xFFFF;
   ltr(SEG_TSS << 3);
+  if(sysenter)
+    wrmsr(MSR_SYSENTER_ESP, (uint)p->kstack + KSTACKSIZE);
   lcr3(V2P(p->pgdir));  // switch to process's address space
   popcli();
 }
@@ -224,7 +255,7 @@ allocuvm(pde_t *pgdir, uint oldsz, uint newsz)
   char *mem;
   uint a;
 
-  if(newsz >= KERNBASE)
+  if(newsz > USERTOP)
     return 0;
   if(newsz < oldsz)
     return oldsz;
@@ -278,6 +309,32 @@ deallocuvm(pde_t *pgdir, uint oldsz, uint newsz)
   return newsz;
 }
 
+// Map the kernel page at kva into pgdir at user address va, with
+// permissions perm. Mapping the same page there again is a no-op.
+int
+mapuserpage(pde_t *pgdir, uint va, char *kva, int perm)
+{
+  pte_t *pte;
+
+  if((pte = walkpgdir(pgdir, (char*)va, 1)) == 0)
+    return -1;
+  if(*pte & PTE_P)
+    return PTE_ADDR(*pte) == V2P(kva) ? 0 : -1;
+  *pte = V2P(kva) | perm | PTE_P;
+  return 0;
+}
+
+// Remove the mapping at va made by mapuserpage(), if any, without
+// freeing the page.
+void
+unmapuserpage(pde_t *pgdir, uint va)
+{
+  pte_t *pte;
+
+  if((pte = walkpgdir(pgdir, (char*)va, 0)) != 0)
+    *pte = 0;
+}
+
 // Free a page table and all the physical memory pages
 // in the user part.
 void
@@ -287,6 +344,10 @@ freevm(pde_t *pgdir)
 
   if(pgdir == 0)
     panic("freevm: no pgdir");
+  // Pages shared with the kernel are not freed here.
+  unmapuserpage(pgdir, TRACEVA);
+  unmapuserpage(pgdir, VDSOVA);
+  unmapuserpage(pgdir, VPROCVA);
   deallocuvm(pgdir, KERNBASE, 0);
   for(i = 0; i < NPDENTRIES; i++){
     if(pgdir[i] & PTE_P){
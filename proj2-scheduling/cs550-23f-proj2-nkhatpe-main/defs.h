@@ -5,6 +5,8 @@ struct inode;
 struct pipe;
 struct proc;
 struct rtcdate;
+struct runq;
+struct schedevent;
 struct spinlock;
 struct sleeplock;
 struct stat;
@@ -78,7 +80,10 @@ int             lapicid(void);
 extern volatile uint*    lapic;
 void            lapiceoi(void);
 void            lapicinit(void);
+void            lapicipi(int);
 void            lapicstartap(uchar, uint);
+void            lapicstarttimer(void);
+void            lapicstoptimer(void);
 void            microdelay(int);
 
 // log.c
@@ -113,7 +118,9 @@ struct proc*    myproc();
 void            pinit(void);
 void            procdump(void);
 void            scheduler(void) __attribute__((noreturn));
+void            rttick(void);
 void            sched(void);
+int             schedtick(struct proc*);
 void            setproc(struct proc*);
 void            sleep(void*, struct spinlock*);
 void            userinit(void);
@@ -121,6 +128,16 @@ int             wait(void);
 void            wakeup(void*);
 void            yield(void);
 
+// runq.c
+void            runqinsert(struct runq*, struct proc*);
+void            runqpush(struct runq*, struct proc*);
+struct proc*    runqdraw(struct runq*, uint);
+struct proc*    runqmin(struct runq*);
+struct proc*    runqpeek(struct runq*);
+struct proc*    runqpop(struct runq*);
+void            runqremove(struct runq*, struct proc*);
+void            runqweight(struct runq*, struct proc*, int);
+
 // swtch.S
 void            swtch(struct context**, struct context*);
 
@@ -159,9 +176,16 @@ void            syscall(void);
 // timer.c
 void            timerinit(void);
 
+// trace.c
+void            traceenable(int);
+void            traceinit(void);
+int             traceread(struct schedevent*, int, uint*);
+void            tracesched(struct cpu*, struct proc*);
+
 // trap.c
 void            idtinit(void);
 extern uint     ticks;
+extern uint64   tsc_per_tick;
 void            tvinit(void);
 extern struct spinlock tickslock;
 
@@ -65,8 +65,7 @@ lapicinit(void)
   // If xv6 cared more about precise timekeeping,
   // TICR would be calibrated using an external time source.
   lapicw(TDCR, X1);
-  lapicw(TIMER, PERIODIC | (T_IRQ0 + IRQ_TIMER));
-  lapicw(TICR, 10000000);
+  lapicstarttimer();
 
   // Disable logical interrupt lines.
   lapicw(LINT0, MASKED);
@@ -113,6 +112,36 @@ lapiceoi(void)
     lapicw(EOI, 0);
 }
 
+// Start (or restart) this CPU's periodic timer.
+void
+lapicstarttimer(void)
+{
+  if(!lapic)
+    return;
+  lapicw(TIMER, PERIODIC | (T_IRQ0 + IRQ_TIMER));
+  lapicw(TICR, 10000000);
+}
+
+// Stop this CPU's timer interrupts while it idles.
+void
+lapicstoptimer(void)
+{
+  if(lapic)
+    lapicw(TIMER, MASKED);
+}
+
+// Interrupt the CPU with the given APIC ID with IRQ_WAKE.
+void
+lapicipi(int apicid)
+{
+  if(!lapic)
+    return;
+  lapicw(ICRHI, apicid<<24);
+  lapicw(ICRLO, FIXED | ASSERT | (T_IRQ0 + IRQ_WAKE));
+  while(lapic[ICRLO] & DELIVS)
+    ;
+}
+
 // Spin for a given number of microseconds.
 // On real hardware would want to tune this dynamically.
 void
@@ -12,3 +12,9 @@
 #define NBUF         (MAXOPBLOCKS*3)  // size of disk block cache
 #define FSSIZE       1000  // size of file system in blocks
 
+// Fork policies selected with set_fork_policy(): which of parent and
+// child the scheduler favours after fork().
+#define FORK_PARENT_FIRST  0  // child joins the tail of a run queue
+#define FORK_CHILD_FIRST   1  // child joins the head of the parent's run queue
+#define FORK_ALTERNATE     2  // child-first on every other fork
+
@@ -6,23 +6,40 @@
 #include "x86.h"
 #include "proc.h"
 #include "spinlock.h"
+#include "schedstat.h"
+#include "pstat.h"
 
-#define INFINITY __INT_MAX__
+#define WAITQ_BITS 6
+#define NWAITQ (1 << WAITQ_BITS)
 
+// The ptable lock also protects the wait queues of sleeping processes.
+// Each CPU's run queues have a lock of their own, so the scheduler can
+// pick and steal without ptable.lock. Lock order: ptable.lock first,
+// then at most one run queue lock at a time.
 struct {
   struct spinlock lock;
+  struct lockstat lockstat;    // Hold times of lock, see sched_get_stats()
   struct proc proc[NPROC];
+  struct proc *waitq[NWAITQ];  // SLEEPING procs, hashed by chan
 } ptable;
 
+static struct spinlock runqlock[NCPU];  // Protects cpus[i].rq and cpus[i].rtq
+
 static struct proc *initproc;
 
 int nextpid = 1;
-int sched_trace_enabled = 0; // ZYF: for OS CPU/process project
-int sched_trace_counter = 0; // ZYF: counter for print formatting
-int sched_policy;	     // Declaring Variable to determine scheduling policy
+int sched_policy;	     // Declaring Variable to determine scheduling policy (SCHED_RR, SCHED_STRIDE, SCHED_LOTTERY or SCHED_MLFQ)
 int STRIDE_TOTAL_TICKETS = 100;	// total number of tickets in the Stride Scheduling policy
-int winner;			// Used for alternate fork function
-int counter = 0;		// Counter for alternate fork function implementation
+int stride_tickets;		// tickets currently held by live processes not funded by a currency
+int CURRENCY_FACE = 100;	// face value of each child when it joins its parent's currency
+int RT_MAX_UTIL = 800;		// per-mille of each CPU that real-time processes may reserve
+#define RT_MAX_PERIOD 1000000	// longest real-time period in ticks; keeps budget * 1000 in an int
+uint64 stride_vtime;		// global virtual time: largest pass dispatched so far
+uint64 rr_seq;			// arrival counter that orders the round robin run queues
+int sched_quantum[SCHED_MLFQ] = { 1, 1, 1 };	// quantum in ticks of round robin, stride and lottery
+int mlfq_quantum[MLFQ_LEVELS] = { 1, 2, 4, 8 };	// MLFQ quantum in ticks at each level
+int mlfq_boost = 100;		// ticks between MLFQ priority boosts
+uint mlfq_lastboost;		// ticks at the last MLFQ priority boost
 extern void forkret(void);
 extern void trapret(void);
 
@@ -31,7 +48,420 @@ static void wakeup1(void *chan);
 void
 pinit(void)
 {
+  struct proc *p;
+
+  int i;
+
   initlock(&ptable.lock, "ptable");
+  ptable.lock.stat = &ptable.lockstat;
+  for(i = 0; i < NCPU; i++)
+    initlock(&runqlock[i], "runq");
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    p->slot = p - ptable.proc + 1;
+}
+
+// Stride for a process holding the given number of tickets.
+static int
+stride_of(int tickets)
+{
+  return (STRIDE_TOTAL_TICKETS * 10) / tickets;
+}
+
+// The lock of CPU c's run queues.
+static struct spinlock*
+rqlock(struct cpu *c)
+{
+  return &runqlock[c - cpus];
+}
+
+// The run queue that p is (or would be) queued in.
+static struct runq*
+rqof(struct proc *p)
+{
+  return p->rtperiod ? &cpus[p->cpu].rtq : &cpus[p->cpu].rq;
+}
+
+// Give p a new number of tickets, keeping its stride and, if it is
+// queued, its run queue's lottery tree up to date.
+// The ptable lock must be held.
+static void
+settickets(struct proc *p, int tickets)
+{
+  acquire(rqlock(&cpus[p->cpu]));
+  if (p->rqidx != 0)
+    runqweight(rqof(p), p, tickets - p->tickets);
+  p->tickets = tickets;
+  release(rqlock(&cpus[p->cpu]));
+  p->strides = stride_of(tickets);
+}
+
+// Share out the value of p between p itself and the members of the
+// currency it funds, in proportion to their face values, and so on down
+// the hierarchy. Every process keeps at least one ticket.
+// The ptable lock must be held.
+static void
+revalue(struct proc *p)
+{
+  struct proc *c;
+  int pool, faces;
+
+  faces = 0;
+  if (p->fundpm > 0)
+    for (c = ptable.proc; c < &ptable.proc[NPROC]; c++)
+      if (c->issuer == p)
+        faces += c->face;
+  if (faces == 0) {
+    settickets(p, p->value);
+    return;
+  }
+
+  pool = p->value * p->fundpm / 1000;
+  settickets(p, p->value - pool > 0 ? p->value - pool : 1);
+  for (c = ptable.proc; c < &ptable.proc[NPROC]; c++) {
+    if (c->issuer != p)
+      continue;
+    c->value = pool * c->face / faces;
+    if (c->value < 1)
+      c->value = 1;
+    revalue(c);
+  }
+}
+
+// Set the value of p, which holds its own tickets.
+// The ptable lock must be held.
+static void
+setvalue(struct proc *p, int value)
+{
+  p->value = value;
+  revalue(p);
+}
+
+// Give tickets back to p. A process funded by a currency is worth what the
+// currency says, so tickets given to it are retired instead.
+// The ptable lock must be held.
+static void
+refund(struct proc *p, int tickets)
+{
+  if (p->issuer == 0)
+    setvalue(p, p->value + tickets);
+  else
+    stride_tickets -= tickets;
+}
+
+// Close the currency that p funds. Its members keep their current value
+// as tickets of their own, and p keeps only its own share: the pool they
+// take with them comes out of p's value, whether p holds its own tickets
+// or is itself funded by a currency.
+// The ptable lock must be held.
+static void
+dissolve(struct proc *p)
+{
+  struct proc *c;
+  int pool;
+
+  pool = p->value - p->tickets;
+  for (c = ptable.proc; c < &ptable.proc[NPROC]; c++) {
+    if (c->issuer != p)
+      continue;
+    c->issuer = 0;
+    c->face = 0;
+    stride_tickets += c->value;
+  }
+  if (p->issuer == 0)
+    stride_tickets -= pool;
+  p->value -= pool;
+  p->fundpm = 0;
+  revalue(p);
+}
+
+// Stride compensation. The scheduler charges a stride per tick up front,
+// so a process that blocks partway through is owed the unused part;
+// wakeproc() credits it back, so that the pass advances only by the
+// fraction of the quantum actually used. now is the time p gave up the CPU.
+// The ptable lock must be held.
+static void
+stride_compensate(struct proc *p, uint64 now)
+{
+  uint64 used, budget;
+  uint charged;
+
+  p->comp = 0;
+  if (tsc_per_tick == 0)
+    return;
+  charged = p->qticks + 1;
+  budget = tsc_per_tick * charged;
+  used = now - p->stamp;
+  if (used >= budget)
+    return;
+
+  // Scale down so that the product below fits in 32 bits.
+  while (budget >> 16) {
+    budget >>= 1;
+    used >>= 1;
+  }
+  p->comp = (uint)p->strides * charged * (uint)(budget - used) / (uint)budget;
+}
+
+// Next number from CPU c's xorshift generator, seeded from the TSC.
+static uint
+lottery_rand(struct cpu *c)
+{
+  uint x;
+
+  x = c->seed;
+  if (x == 0)
+    x = (uint)rdtsc() | 1;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  c->seed = x;
+  return x;
+}
+
+// Set the key that orders p in its run queue under the current policy:
+// its pass for stride, its level and then arrival order for MLFQ, and
+// its arrival order for round robin and lottery. Real-time processes
+// are ordered by deadline whatever the policy.
+static void
+setrqkey(struct proc *p)
+{
+  if (p->rtperiod)
+    p->rqkey = p->rtdeadline;
+  else if (sched_policy == SCHED_STRIDE)
+    p->rqkey = p->pass;
+  else if (sched_policy == SCHED_MLFQ)
+    p->rqkey = ((uint64)p->level << 56) | rr_seq++;
+  else
+    p->rqkey = rr_seq++;
+}
+
+// Wait queue that a process sleeping on chan is kept in, so wakeup()
+// looks only at the processes that may be sleeping on the same chan.
+static struct proc**
+waitq(void *chan)
+{
+  return &ptable.waitq[((uint)chan * 2654435761U) >> (32 - WAITQ_BITS)];
+}
+
+// Whether any process is sleeping on chan.
+// The ptable lock must be held.
+static int
+sleeping_on(void *chan)
+{
+  struct proc *p;
+
+  for (p = *waitq(chan); p != 0; p = p->wnext)
+    if (p->chan == chan)
+      return 1;
+  return 0;
+}
+
+// Whether p's affinity mask lets it run on CPU c.
+static int
+allowed(struct proc *p, struct cpu *c)
+{
+  return (p->affinity >> (c - cpus)) & 1;
+}
+
+// The CPU that p may run on with the least work queued or running,
+// where a new process is placed or a process moved off a CPU that its
+// affinity mask no longer allows. The queue lengths are read without
+// their locks; a stale one only places p less well.
+// The ptable lock must be held.
+static int
+idlestcpu(struct proc *p)
+{
+  int i, best, load, bestload;
+
+  best = -1;
+  bestload = 0;
+  for (i = 0; i < ncpu; i++) {
+    if (!allowed(p, &cpus[i]))
+      continue;
+    load = cpus[i].rq.n + (cpus[i].proc != 0);
+    if (best < 0 || load < bestload) {
+      best = i;
+      bestload = load;
+    }
+  }
+  return best;
+}
+
+// Work was just queued on CPU c. If c has stopped its timer to idle,
+// interrupt it so it runs the work; if c is busy, interrupt some other
+// tickless CPU so it can steal the work.
+// The run queue lock of c must be held, so c cannot stop its timer
+// unseen; another CPU may, and the work then waits for c's next tick.
+static void
+kickcpu(struct cpu *c)
+{
+  struct cpu *o;
+
+  if (c->tickless) {
+    if (c != mycpu())
+      lapicipi(c->apicid);
+    return;
+  }
+  if (c->proc == 0)
+    return;
+  for (o = cpus; o < &cpus[ncpu]; o++) {
+    if (o->tickless && o != mycpu()) {
+      lapicipi(o->apicid);
+      return;
+    }
+  }
+}
+
+// Mark p RUNNABLE and put it on the run queue of the CPU it last ran on,
+// where its cache and TLB state may still be warm, unless its affinity
+// mask no longer allows that CPU. A real-time process stays on the CPU
+// that admitted it and, once it has used up its budget, is not queued
+// until rttick() starts its next period. If front is set, p goes ahead
+// of everything already queued instead of behind it.
+// The ptable lock must be held.
+static void
+enqueue(struct proc *p, int front)
+{
+  if (p->rtperiod == 0 && !allowed(p, &cpus[p->cpu]))
+    p->cpu = idlestcpu(p);
+  p->state = RUNNABLE;
+  p->stamp = rdtsc();
+  if (p->rtthrottled)
+    return;
+  setrqkey(p);
+  acquire(rqlock(&cpus[p->cpu]));
+  if (front)
+    runqpush(rqof(p), p);
+  else
+    runqinsert(rqof(p), p);
+  kickcpu(&cpus[p->cpu]);
+  release(rqlock(&cpus[p->cpu]));
+}
+
+static void
+setrunnable(struct proc *p)
+{
+  enqueue(p, 0);
+}
+
+// Take p off its run queue if it is queued. Returns whether it was;
+// a RUNNABLE p that is not has been picked by some CPU's scheduler,
+// which checks again under the ptable lock before running it.
+// The ptable lock must be held.
+static int
+dequeue(struct proc *p)
+{
+  int queued;
+
+  acquire(rqlock(&cpus[p->cpu]));
+  queued = p->rqidx != 0;
+  if (queued)
+    runqremove(rqof(p), p);
+  release(rqlock(&cpus[p->cpu]));
+  return queued;
+}
+
+// Move p to its place in its run queue after a change to its key.
+// The ptable lock must be held.
+static void
+requeue(struct proc *p)
+{
+  acquire(rqlock(&cpus[p->cpu]));
+  if (p->rqidx != 0) {
+    runqremove(rqof(p), p);
+    setrqkey(p);
+    runqinsert(rqof(p), p);
+  }
+  release(rqlock(&cpus[p->cpu]));
+}
+
+// Take p out of the real-time class, releasing its reservation.
+// The ptable lock must be held.
+static void
+rt_leave(struct proc *p)
+{
+  int queued;
+
+  if (p->rtperiod == 0)
+    return;
+  queued = dequeue(p);
+  cpus[p->cpu].nrt--;
+  cpus[p->cpu].rtutil -= p->rtutil;
+  p->rtperiod = 0;
+  p->rtbudget = 0;
+  p->rtutil = 0;
+  if ((queued || p->rtthrottled) && p->state == RUNNABLE) {
+    p->rtthrottled = 0;
+    setrunnable(p);
+  }
+  p->rtthrottled = 0;
+}
+
+// Whether idle CPU c may stop its timer. Every run queue is empty, or c
+// would have stolen from it, and whatever queues work later wakes c with
+// an IPI. CPU 0 also keeps time, so it keeps its timer while any other
+// CPU is running a process or has real-time processes, whose periods
+// rttick() starts by ticks, while a process sleeps on ticks, or before
+// the tick length is known (trap.c).
+// The run queue lock of c must be held, and for CPU 0 the ptable lock.
+static int
+canstoptimer(struct cpu *c)
+{
+  struct cpu *o;
+
+  if (c->nrt > 0)
+    return 0;  // rttick() must see every tick
+  if (c != &cpus[0])
+    return 1;
+  if (tsc_per_tick == 0)
+    return 0;
+  for (o = cpus; o < &cpus[ncpu]; o++)
+    if (o->proc != 0 || o->nrt > 0)
+      return 0;
+  return !sleeping_on(&ticks);
+}
+
+// CPU c found nothing to run: stop its timer until an interrupt
+// arrives, if it may. CPU 0 takes the ptable lock to look at the other
+// CPUs, and so that none of them starts a process unseen meanwhile.
+static void
+cpuidle(struct cpu *c)
+{
+  if (c == &cpus[0])
+    acquire(&ptable.lock);
+  acquire(rqlock(c));
+  c->idles++;
+  tracesched(c, 0);
+  if (c->rq.n == 0 && c->rtq.n == 0 && canstoptimer(c)) {
+    c->idlestart = rdtsc();
+    c->tickless = 1;
+    lapicstoptimer();
+  }
+  release(rqlock(c));
+  if (c == &cpus[0])
+    release(&ptable.lock);
+}
+
+// Make a sleeping process runnable again. It rejoins at the current
+// virtual time, so the pass it did not use while asleep cannot be
+// spent all at once to monopolize the CPU.
+// The ptable lock must be held.
+static void
+wakeproc(struct proc *p)
+{
+  struct proc **pp;
+
+  for (pp = waitq(p->chan); *pp != p; pp = &(*pp)->wnext)
+    if (*pp == 0)
+      panic("wakeproc");
+  *pp = p->wnext;
+  p->wnext = 0;
+
+  if (PASS_LT(p->pass, stride_vtime))
+    p->pass = stride_vtime;
+  p->pass -= p->comp;
+  p->comp = 0;
+  setrunnable(p);
 }
 
 // Must be called with interrupts disabled
@@ -96,6 +526,24 @@ allocproc(void)
 found:
   p->state = EMBRYO;
   p->pid = nextpid++;
+  p->runticks = 0;
+  p->nsched = 0;
+  p->nswitch = 0;
+  p->npreempt = 0;
+  p->runcycles = 0;
+  p->waitcycles = 0;
+  p->level = 0;
+  p->qticks = 0;
+  p->value = 0;
+  p->issuer = 0;
+  p->face = 0;
+  p->fundpm = 0;
+  p->comp = 0;
+  p->rtperiod = 0;
+  p->rtbudget = 0;
+  p->rtutil = 0;
+  p->rtthrottled = 0;
+  p->nforks = 0;
 
   release(&ptable.lock);
 
@@ -123,6 +571,53 @@ found:
   return p;
 }
 
+// Hand an exiting process's tickets back to its parent, retiring any
+// that fork() had to create so the total drifts back to STRIDE_TOTAL_TICKETS.
+// Only the exiting process and its parent are touched.
+// The ptable lock must be held.
+static void
+stride_return_tickets(struct proc *p)
+{
+  struct proc *parent, *issuer;
+  int give, excess;
+
+  // Children funded by p's currency keep their tickets.
+  if (p->fundpm > 0)
+    dissolve(p);
+
+  // A process funded by a currency only leaves it: its value was
+  // never its own, and the currency's other members share it out.
+  if (p->issuer != 0) {
+    issuer = p->issuer;
+    p->issuer = 0;
+    p->face = 0;
+    revalue(issuer);
+    p->value = 0;
+    p->tickets = 0;
+    p->strides = 0;
+    return;
+  }
+
+  parent = p->parent;
+  if (parent == 0 || parent->state == ZOMBIE)
+    parent = initproc;
+
+  give = p->value;
+  excess = stride_tickets - STRIDE_TOTAL_TICKETS;
+  if (excess > 0) {
+    if (excess > give)
+      excess = give;
+    give -= excess;
+    stride_tickets -= excess;
+  }
+  if (give > 0)
+    refund(parent, give);
+
+  p->value = 0;
+  p->tickets = 0;
+  p->strides = 0;
+}
+
 //PAGEBREAK: 32
 // Set up first user process.
 void userinit(void)
@@ -171,39 +666,15 @@ void userinit(void)
   // Acquire the process table lock before changing process state
   acquire(&ptable.lock);
 
-  // Set the process state to RUNNABLE, allowing it to run
-  p->state = RUNNABLE;
-
-  // Calculate the number of currently running processes
-  struct proc *x;
-  int proc_count = 0;
-  for (x = ptable.proc; x < &ptable.proc[NPROC]; x++)
-  {
-    if (x->state == RUNNING || x->state == RUNNABLE)
-    {
-      proc_count++;
-    }
-  }
-
-  // Calculate the number of tickets each process should have
-  int tickets_per_proc = STRIDE_TOTAL_TICKETS / proc_count;
+  // The first process starts out holding every ticket in the system.
+  setvalue(p, STRIDE_TOTAL_TICKETS);
+  p->pass = stride_vtime;
+  p->cpu = 0;
+  p->affinity = ~0;
+  stride_tickets = STRIDE_TOTAL_TICKETS;
 
-  // Initialize stride scheduling parameters for all processes
-  for (x = ptable.proc; x < &ptable.proc[NPROC]; x++)
-  {
-    if (x->state == RUNNING || x->state == RUNNABLE)
-    {
-      x->tickets = tickets_per_proc;
-      x->strides = (STRIDE_TOTAL_TICKETS * 10) / x->tickets;
-      x->pass = 0;
-    }
-    else
-    {
-      x->tickets = 0;
-      x->strides = 0;
-      x->pass = 0;
-    }
-  }
+  // Set the process state to RUNNABLE, allowing it to run
+  setrunnable(p);
 
   // Release the process table lock
   release(&ptable.lock);
@@ -237,7 +708,7 @@ growproc(int n)
 int 
 fork(void)
 {
-  int i, pid;
+  int i, pid, child_first;
   struct proc *np;
   struct proc *curproc = myproc();
 
@@ -277,48 +748,54 @@ fork(void)
   // Acquire the process table lock before changing process state.
   acquire(&ptable.lock);
 
-  // Set the child process's state to RUNNABLE, allowing it to be scheduled.
-  np->state = RUNNABLE;
-
-  // Calculate the number of currently running processes.
-  struct proc *p;
-  int proc_count = 0;
-
-  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++) {
-    if (p->state == RUNNING || p->state == RUNNABLE) {
-      proc_count++;
-    }
+  // A parent that funds a currency brings the child into it. A parent that
+  // is itself funded by one splits its face value there with the child.
+  // Otherwise fund the child with half of the parent's tickets so the total
+  // in circulation stays at STRIDE_TOTAL_TICKETS. A parent down to its last
+  // ticket cannot split it, so the child gets a new one; exit() retires it.
+  if (curproc->fundpm > 0) {
+    np->issuer = curproc;
+    np->face = CURRENCY_FACE;
+    revalue(curproc);
+  } else if (curproc->issuer != 0) {
+    np->issuer = curproc->issuer;
+    np->face = curproc->face > 1 ? curproc->face / 2 : 1;
+    if (curproc->face > 1)
+      curproc->face -= np->face;
+    revalue(curproc->issuer);
+  } else if (curproc->value > 1) {
+    setvalue(np, curproc->value / 2);
+    setvalue(curproc, curproc->value - np->value);
+  } else {
+    setvalue(np, 1);
+    stride_tickets++;
   }
 
-  // Calculate the number of tickets each process should have for stride scheduling.
-  int tickets_per_proc = STRIDE_TOTAL_TICKETS / proc_count;
+  // The child joins at the current virtual time rather than at zero,
+  // on whichever CPU has the least work.
+  np->pass = stride_vtime;
+  np->affinity = curproc->affinity;
+  np->forkpolicy = curproc->forkpolicy;
+  np->cpu = idlestcpu(np);
+
+  // Parent-first queues the child behind everything else on the idlest
+  // CPU. Child-first starts it on an idle CPU if there is one, and
+  // otherwise puts it at the head of the parent's run queue so it is
+  // the next to run there once the parent blocks (a shell waiting for
+  // it, say) or its slice ends. Alternate is child-first on every other
+  // fork, starting with the second.
+  child_first = curproc->forkpolicy == FORK_CHILD_FIRST ||
+                (curproc->forkpolicy == FORK_ALTERNATE && curproc->nforks % 2 == 1);
+  curproc->nforks++;
+  if (child_first && cpus[np->cpu].proc != 0 && allowed(np, mycpu()))
+    np->cpu = cpuid();
 
-  // Initialize stride scheduling parameters for all processes.
-  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++) {
-    if (p->state == RUNNING || p->state == RUNNABLE) {
-      p->tickets = tickets_per_proc;
-      p->strides = (STRIDE_TOTAL_TICKETS * 10) / p->tickets;
-      p->pass = 0;
-    } else {
-      p->tickets = 0;
-      p->strides = 0;
-      p->pass = 0;
-    }
-  }
+  // Set the child process's state to RUNNABLE, allowing it to be scheduled.
+  enqueue(np, child_first);
 
   // Release the process table lock.
   release(&ptable.lock);
 
-  // Check if the child process should yield the CPU.
-  if (winner == 1) {
-    if (counter % 2 == 1) {
-      counter++;
-      yield(); // Yield the CPU to another process.
-    } else {
-      counter++;
-    }
-  }
-
   return pid; // Return the child process's ID (pid).
 }
 
@@ -368,31 +845,11 @@ void exit(void)
   // Set the current process state to ZOMBIE, indicating it has exited.
   curproc->state = ZOMBIE;
 
-  // Calculate the number of currently running processes.
-  struct proc *x;
-  int proc_count = 0;
-
-  for (x = ptable.proc; x < &ptable.proc[NPROC]; x++) {
-    if (x->state == RUNNING || x->state == RUNNABLE) {
-      proc_count++;
-    }
-  }
-
-  // Calculate the number of tickets each process should have for stride scheduling.
-  int tickets_per_proc = STRIDE_TOTAL_TICKETS / proc_count;
+  // Return the tickets to the parent (or to init if the parent is exiting too).
+  stride_return_tickets(curproc);
 
-  // Initialize stride scheduling parameters for all processes.
-  for (x = ptable.proc; x < &ptable.proc[NPROC]; x++) {
-    if (x->state == RUNNING || x->state == RUNNABLE) {
-      x->tickets = tickets_per_proc;
-      x->strides = (STRIDE_TOTAL_TICKETS * 10) / x->tickets;
-      x->pass = 0;
-    } else {
-      x->tickets = 0;
-      x->strides = 0;
-      x->pass = 0;
-    }
-  }
+  // Release any real-time reservation.
+  rt_leave(curproc);
 
   sched(); // Jump into the scheduler, never to return.
 
@@ -443,6 +900,73 @@ wait(void)
   }
 }
 
+// Choose the next process for CPU c and take it off its run queue.
+// Real-time processes queued on c come first, earliest deadline first.
+// Under lottery, the winner is drawn from the tickets queued on c.
+// A CPU runs from its own queue so processes keep their cache state,
+// and steals from another CPU only when it has nothing queued: the
+// busiest queue under round robin, the lowest pass under stride. It only
+// steals a process whose affinity mask allows this CPU.
+// Under stride it also steals when another CPU's best process lags
+// its own by more than a full stride, so the shared virtual time keeps
+// the CPUs within about one quantum of each other.
+// Only the run queue locks are taken, one at a time: the other CPUs'
+// queues are peeked at without theirs, and the victim's best process
+// is checked again under its lock before it is stolen.
+static struct proc*
+pickproc(struct cpu *c)
+{
+  struct cpu *o, *victim;
+  struct proc *p, *q, *best;
+
+  acquire(rqlock(c));
+  if ((p = runqpop(&c->rtq)) != 0)
+    goto out;
+
+  if (sched_policy == SCHED_LOTTERY && c->rq.tickets > 0) {
+    p = runqdraw(&c->rq, lottery_rand(c) % c->rq.tickets);
+    runqremove(&c->rq, p);
+    goto out;
+  }
+
+  p = runqmin(&c->rq);
+  release(rqlock(c));
+
+  best = p;
+  victim = 0;
+  for (o = cpus; o < &cpus[ncpu]; o++) {
+    if (o == c || (q = runqpeek(&o->rq)) == 0 || !allowed(q, c))
+      continue;
+    if (sched_policy == SCHED_STRIDE) {
+      if (p == 0 && best != 0 && !PASS_LT(q->pass, best->pass))
+        continue;
+      if (p != 0 && !(PASS_LT(q->pass + q->strides, p->pass) && PASS_LT(q->pass, best->pass)))
+        continue;
+      best = q;
+      victim = o;
+    } else if (p == 0 && (victim == 0 || o->rq.n > victim->rq.n)) {
+      victim = o;
+    }
+  }
+
+  if (victim) {
+    acquire(rqlock(victim));
+    if ((q = runqmin(&victim->rq)) != 0 && allowed(q, c)) {
+      runqremove(&victim->rq, q);
+      release(rqlock(victim));
+      c->steals++;
+      return q;
+    }
+    release(rqlock(victim));
+  }
+
+  acquire(rqlock(c));
+  p = runqpop(&c->rq);
+out:
+  release(rqlock(c));
+  return p;
+}
+
 //PAGEBREAK: 42
 // Per-CPU process scheduler.
 // Each CPU calls scheduler() after setting itself up.
@@ -455,8 +979,8 @@ void
 scheduler(void)
 {
   struct proc *p;
-  struct proc *min_pass_proc = 0;
   struct cpu *c = mycpu();
+  uint64 start, now;
   c->proc = 0;
 
   int ran = 0; // CS 350/550: to solve the 100%-CPU-utilization-when-idling problem
@@ -466,75 +990,77 @@ scheduler(void)
     // Enable interrupts on this processor.
     sti();
 
-    // Loop over process table looking for a process to run.
-    acquire(&ptable.lock);
+    // Take the next process off this CPU's run queue (or steal one).
+    start = rdtsc();
 
-    if (sched_policy)
+    ran = 0;
+
+    if ((p = pickproc(c)) != 0)
     {
-      // Stride Scheduling Policy
+      acquire(&ptable.lock);
 
-      int min_pass = INFINITY;
+      // p was picked without the ptable lock. If it has since been made
+      // real-time on another CPU or its affinity no longer allows this
+      // one, queue it again where it now belongs.
+      if (p->rtperiod ? &cpus[p->cpu] != c : !allowed(p, c))
+      {
+        setrunnable(p);
+        release(&ptable.lock);
+        continue;
+      }
 
-      ran = 0;
+      ran = 1;
 
-      // Find the process with the minimum pass value (the next to run).
-      for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-      {
-        if (p->state != RUNNABLE)
-          continue;
+      tracesched(c, p);
 
-        if (p->pass < min_pass)
-        {
-          min_pass = p->pass;
-          min_pass_proc = p;
-        }
+      if (sched_policy == SCHED_STRIDE)
+      {
+        // Stride Scheduling Policy: the dispatched pass is the current virtual time.
+        if (PASS_LT(stride_vtime, p->pass))
+          stride_vtime = p->pass;
+        p->pass = p->pass + p->strides;
       }
 
-      ran = 1;
+      // Set the CPU's current process to the one being scheduled.
+      c->proc = p;
+      p->cpu = c - cpus;
+      if (sched_policy != SCHED_MLFQ)
+        p->qticks = 0;
+
+      // CPU 0 keeps time, so it must not stay tickless while a process runs.
+      if (cpus[0].tickless && c != &cpus[0])
+        lapicipi(cpus[0].apicid);
+
+      switchuvm(p);
+      p->state = RUNNING;
 
-      // Set the CPU's current process to the one with the minimum pass value.
-      c->proc = min_pass_proc;
-      min_pass_proc->pass = min_pass_proc->pass + min_pass_proc->strides;
-      switchuvm(min_pass_proc);
-      min_pass_proc->state = RUNNING;
+      // Charge the time since it was queued as run queue wait.
+      now = rdtsc();
+      c->picks++;
+      c->pickcycles += now - start;
+      p->nsched++;
+      p->waitcycles += now - p->stamp;
+      p->stamp = now;
 
       // Switch to the chosen process's context.
-      swtch(&(c->scheduler), min_pass_proc->context);
+      swtch(&(c->scheduler), p->context);
       switchkvm();
 
+      // Process is done running for now.
+      // It should have changed its p->state before coming back.
       c->proc = 0; // Reset the CPU's current process to 0.
+
+      release(&ptable.lock);
     }
     else
     {
-      // Round Robin Scheduling Policy as it is
-
-      ran = 0;
-
-      for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-      {
-        if (p->state != RUNNABLE)
-          continue;
-
-        ran = 1;
-
-        // Set the CPU's current process to the one being scheduled.
-        c->proc = p;
-        switchuvm(p);
-        p->state = RUNNING;
-
-        // Switch to the chosen process's context.
-        swtch(&(c->scheduler), p->context);
-        switchkvm();
-
-        // Process is done running for now.
-        // It should have changed its p->state before coming back.
-        c->proc = 0; // Reset the CPU's current process to 0.
-      }
+      // Nothing to run: stop the timer until an interrupt arrives.
+      cpuidle(c);
     }
 
-    release(&ptable.lock);
-
     // If no process was scheduled (ran == 0), halt the CPU to save power.
+    // An interrupt that arrives before the hlt restarts a stopped timer (trap.c),
+    // so the CPU still wakes up at the next tick.
     if (ran == 0)
     {
       halt();
@@ -554,6 +1080,7 @@ void
 sched(void)
 {
   int intena;
+  uint64 now;
   struct proc *p = myproc();
 
   if(!holding(&ptable.lock))
@@ -564,6 +1091,15 @@ sched(void)
     panic("sched running");
   if(readeflags()&FL_IF)
     panic("sched interruptible");
+
+  // Charge the time since dispatch as run time.
+  now = rdtsc();
+  p->runcycles += now - p->stamp;
+  if(p->state != ZOMBIE)
+    p->nswitch++;
+  if(p->state == SLEEPING && sched_policy == SCHED_STRIDE)
+    stride_compensate(p, now);
+
   intena = mycpu()->intena;
   swtch(&p->context, mycpu()->scheduler);
   mycpu()->intena = intena;
@@ -573,25 +1109,131 @@ sched(void)
 void
 yield(void)
 {
-  if (sched_trace_enabled)
-  {
-    cprintf("%d", myproc()->pid);
-    
-    sched_trace_counter++;
-    if (sched_trace_counter % 20 == 0)
-    {
-      cprintf("\n");
+  acquire(&ptable.lock);  //DOC: yieldlock
+  setrunnable(myproc());
+  sched();
+  release(&ptable.lock);
+}
+
+// Move every process back to the top MLFQ level so that processes
+// demoted to the bottom are not starved.
+// The ptable lock must be held.
+static void
+mlfq_boost_all(void)
+{
+  struct proc *p;
+
+  mlfq_lastboost = ticks;
+  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++) {
+    if (p->state == UNUSED)
+      continue;
+    p->level = 0;
+    p->qticks = 0;
+    if (p->rtperiod == 0)
+      requeue(p);
+  }
+}
+
+// Called from trap() on every timer tick of every CPU. Starts the next
+// period of each real-time process on this CPU whose deadline has
+// passed: its budget is replenished, and if it was throttled it is
+// queued again.
+void
+rttick(void)
+{
+  struct cpu *c;
+  struct proc *p;
+
+  c = mycpu();
+  if (c->nrt == 0)
+    return;
+
+  acquire(&ptable.lock);
+  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++) {
+    if (p->rtperiod == 0 || &cpus[p->cpu] != c || (int)(ticks - p->rtdeadline) < 0)
+      continue;
+    while ((int)(ticks - p->rtdeadline) >= 0)
+      p->rtdeadline += p->rtperiod;
+    p->rtused = 0;
+    if (p->rtthrottled) {
+      p->rtthrottled = 0;
+      if (p->state == RUNNABLE)
+        setrunnable(p);
+    } else {
+      requeue(p);
     }
-    else
-    {
-      cprintf(" - ");
+  }
+  release(&ptable.lock);
+}
+
+// Called from trap() on every timer tick taken by the running process p.
+// Returns whether p should give up the CPU: when it has used up the
+// quantum of the current policy and another process is waiting on this
+// CPU. Under MLFQ the quantum depends on p's level, using it up demotes
+// p, and p also gives way to a process of a higher level.
+int
+schedtick(struct proc *p)
+{
+  struct cpu *c = mycpu();
+  struct proc *q;
+  int preempt, rtwaiting, waiting, level;
+
+  acquire(&ptable.lock);
+
+  if (sched_policy == SCHED_MLFQ && p->rtperiod == 0 && ticks - mlfq_lastboost >= mlfq_boost)
+    mlfq_boost_all();
+
+  // Look at the best processes queued on this CPU.
+  acquire(rqlock(c));
+  q = runqmin(&c->rtq);
+  rtwaiting = q != 0 && (p->rtperiod == 0 || (int)(q->rtdeadline - p->rtdeadline) < 0);
+  q = runqmin(&c->rq);
+  waiting = q != 0;
+  level = q != 0 ? q->level : MLFQ_LEVELS;
+  release(rqlock(c));
+
+  // A real-time process runs until it has used its budget for this
+  // period or one with an earlier deadline is queued. Anything else
+  // gives way to a queued real-time process at once.
+  if (p->rtperiod) {
+    preempt = rtwaiting;
+    if (++p->rtused >= p->rtbudget) {
+      p->rtthrottled = 1;
+      preempt = 1;
     }
+    release(&ptable.lock);
+    return preempt;
   }
-    
-  acquire(&ptable.lock);  //DOC: yieldlock
-  myproc()->state = RUNNABLE;
-  sched();
+  if (rtwaiting) {
+    release(&ptable.lock);
+    return 1;
+  }
+
+  preempt = 0;
+  if (sched_policy == SCHED_MLFQ) {
+    if (++p->qticks >= mlfq_quantum[p->level]) {
+      if (p->level < MLFQ_LEVELS - 1)
+        p->level++;
+      p->qticks = 0;
+      preempt = 1;
+    }
+    if (level < p->level)
+      preempt = 1;
+  } else if (++p->qticks >= sched_quantum[sched_policy]) {
+    preempt = 1;
+  }
+
+  // Switching to nothing is pointless; keep running until something is queued.
+  if (!waiting)
+    preempt = 0;
+
+  // Stride charged one tick at dispatch; charge each further tick p keeps the CPU.
+  if (!preempt && sched_policy == SCHED_STRIDE)
+    p->pass = p->pass + p->strides;
+
   release(&ptable.lock);
+
+  return preempt;
 }
 
 // A fork child's very first scheduling by scheduler()
@@ -641,6 +1283,16 @@ sleep(void *chan, struct spinlock *lk)
   // Go to sleep.
   p->chan = chan;
   p->state = SLEEPING;
+  p->wnext = *waitq(chan);
+  *waitq(chan) = p;
+
+  // Under MLFQ a process that blocks before using up its quantum
+  // moves up a level, so interactive processes stay ahead of CPU hogs.
+  if (sched_policy == SCHED_MLFQ) {
+    if (p->level > 0)
+      p->level--;
+    p->qticks = 0;
+  }
 
   sched();
 
@@ -660,11 +1312,13 @@ sleep(void *chan, struct spinlock *lk)
 static void
 wakeup1(void *chan)
 {
-  struct proc *p;
+  struct proc *p, *next;
 
-  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-    if(p->state == SLEEPING && p->chan == chan)
-      p->state = RUNNABLE;
+  for(p = *waitq(chan); p != 0; p = next){
+    next = p->wnext;
+    if(p->chan == chan)
+      wakeproc(p);
+  }
 }
 
 // Wake up all processes sleeping on chan.
@@ -690,7 +1344,7 @@ kill(int pid)
       p->killed = 1;
       // Wake process from sleep if necessary.
       if(p->state == SLEEPING)
-        p->state = RUNNABLE;
+        wakeproc(p);
       release(&ptable.lock);
       return 0;
     }
@@ -762,10 +1416,20 @@ int tickets_transfer(int pid, int tickets, struct proc *p)
   struct proc *x;
   int tickets_transferred = 0;
 
-  // Iterate through the process table to find the process with the matching 'pid'.
+  // Ticket counts are updated incrementally by fork() and exit(), so hold the lock.
+  acquire(&ptable.lock);
+
+  // Check if the number of tickets to transfer is greater than the current process's tickets minus 1.
+  if (p->issuer == 0 && tickets > p->tickets - 1)
+  {
+    release(&ptable.lock);
+    return -2; // Return an error if the transfer is not allowed.
+  }
+
+  // Iterate through the process table to find the live process with the matching 'pid'.
   for (x = ptable.proc; x < &ptable.proc[NPROC]; x++)
   {
-    if (x->pid == pid)
+    if (x->pid == pid && x->state != UNUSED && x->state != ZOMBIE)
     {
       // Reset the transferred tickets count to 0 and exit the loop.
       tickets_transferred = 0;
@@ -781,19 +1445,336 @@ int tickets_transfer(int pid, int tickets, struct proc *p)
   // Check if a valid process with the specified 'pid' was found.
   if (tickets_transferred == -3)
   {
+    release(&ptable.lock);
     return tickets_transferred; // Return -3 to indicate that the specified process was not found.
   }
 
-  // Update the number of tickets and stride for both the target process and the current process.
-  x->tickets = x->tickets + tickets;
-  x->strides = (STRIDE_TOTAL_TICKETS * 10) / x->tickets;
+  // Members of the same currency trade face value in it; tickets cannot move in or out of a currency.
+  if (x->issuer != 0 || p->issuer != 0)
+  {
+    if (x->issuer != p->issuer)
+    {
+      release(&ptable.lock);
+      return -3;
+    }
+    if (tickets > p->face - 1)
+    {
+      release(&ptable.lock);
+      return -2;
+    }
+    p->face = p->face - tickets;
+    x->face = x->face + tickets;
+    revalue(p->issuer);
+    tickets_transferred = p->tickets;
+    release(&ptable.lock);
+    return tickets_transferred;
+  }
 
-  p->tickets = p->tickets - tickets;
-  p->strides = (STRIDE_TOTAL_TICKETS * 10) / p->tickets;
+  // Update the value (and so the tickets and stride) of both the target process and the current process.
+  setvalue(x, x->value + tickets);
+  setvalue(p, p->value - tickets);
 
   // Return the number of tickets remaining for the current process after the transfer.
   tickets_transferred = p->tickets;
 
+  release(&ptable.lock);
+
   return tickets_transferred;
 }
 
+
+// Function to switch the scheduling policy (0 for Round Robin, 1 for Stride Scheduling, 2 for Lottery, 3 for MLFQ).
+// Queued processes are re-keyed for the new policy and re-inserted.
+void sched_set_policy(int policy)
+{
+  struct cpu *c;
+  struct proc *queued[NPROC+1];
+  int i, n;
+
+  acquire(&ptable.lock);
+
+  sched_policy = policy;
+
+  for (c = cpus; c < &cpus[ncpu]; c++)
+  {
+    acquire(rqlock(c));
+    n = 0;
+    while ((queued[n] = runqpop(&c->rq)) != 0)
+      n++;
+    for (i = 0; i < n; i++)
+    {
+      setrqkey(queued[i]);
+      runqinsert(&c->rq, queued[i]);
+    }
+    release(rqlock(c));
+  }
+
+  release(&ptable.lock);
+}
+
+// Function to take a snapshot of the scheduler statistics.
+void sched_get_stats(struct schedstat *st)
+{
+  int i;
+
+  memset(st, 0, sizeof(*st));
+
+  acquire(&ptable.lock);
+
+  st->ncpu = ncpu;
+  st->lockacquires = ptable.lockstat.nacquire;
+  st->lockcycles = ptable.lockstat.holdcycles;
+  for (i = 0; i < ncpu; i++)
+  {
+    st->cpu[i].picks = cpus[i].picks;
+    st->cpu[i].steals = cpus[i].steals;
+    st->cpu[i].idles = cpus[i].idles;
+    st->cpu[i].pickcycles = cpus[i].pickcycles;
+    st->cpu[i].ticklesscycles = cpus[i].ticklesscycles;
+    st->cpu[i].skipped = cpus[i].skipped;
+  }
+
+  release(&ptable.lock);
+}
+
+// Function to take a snapshot of the scheduler accounting of the process with 'pid',
+// or of every process if 'pid' is not positive. Returns the number of entries filled.
+int procs_stats(int pid, struct pstat *ps)
+{
+  struct proc *p;
+  struct procstat *st;
+
+  memset(ps, 0, sizeof(*ps));
+
+  acquire(&ptable.lock);
+
+  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+  {
+    if (p->state == UNUSED || (pid > 0 && p->pid != pid))
+      continue;
+
+    st = &ps->proc[ps->nproc++];
+    st->pid = p->pid;
+    st->state = p->state;
+    st->tickets = p->tickets;
+    st->runticks = p->runticks;
+    st->nsched = p->nsched;
+    st->nvoluntary = p->nswitch - p->npreempt;
+    st->ninvoluntary = p->npreempt;
+    st->runcycles = p->runcycles;
+    st->waitcycles = p->waitcycles;
+  }
+
+  release(&ptable.lock);
+
+  return ps->nproc;
+}
+
+// Function to set the number of ticks between MLFQ priority boosts. Returns the previous interval.
+int mlfq_set_boost(int ticks)
+{
+  int old;
+
+  acquire(&ptable.lock);
+  old = mlfq_boost;
+  mlfq_boost = ticks;
+  release(&ptable.lock);
+
+  return old;
+}
+
+// Function to set the quantum in ticks of round robin, stride or lottery. Returns the previous quantum.
+int sched_set_quantum(int policy, int ticks)
+{
+  int old;
+
+  acquire(&ptable.lock);
+  old = sched_quantum[policy];
+  sched_quantum[policy] = ticks;
+  release(&ptable.lock);
+
+  return old;
+}
+
+// Function to set the CPUs (bit i for CPU i) that the process with 'pid' may run on.
+// A queued process moves to an allowed CPU at once, a running one when it next gives
+// up the CPU; the caller gives up the CPU right away if it is no longer allowed on it.
+int procs_set_affinity(int pid, uint mask)
+{
+  struct proc *p;
+  int found = 0, move = 0;
+
+  mask &= (1 << ncpu) - 1;
+  if (mask == 0)
+    return -1;
+
+  acquire(&ptable.lock);
+
+  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+  {
+    if (p->pid == pid && p->state != UNUSED && p->state != ZOMBIE)
+    {
+      found = 1;
+      p->affinity = mask;
+      if (p->rtperiod == 0 && !allowed(p, &cpus[p->cpu]) && dequeue(p))
+        setrunnable(p);
+      move = (p == myproc() && !allowed(p, mycpu()));
+      break;
+    }
+  }
+
+  release(&ptable.lock);
+
+  if (move)
+    yield();
+
+  return found ? 0 : -1;
+}
+
+// Function to put 'tickets' of the current process behind a currency that funds its children,
+// present and future, in equal shares; their value follows the currency from then on, and any
+// tickets of their own go back to the parent first. 0 closes the currency.
+// Returns the tickets the current process keeps for itself, or -2 if it cannot spare 'tickets'.
+int procs_fund_children(int tickets, struct proc *p)
+{
+  struct proc *c;
+  int kept, value;
+
+  acquire(&ptable.lock);
+
+  if (tickets == 0)
+  {
+    if (p->fundpm > 0)
+      dissolve(p);
+    kept = p->tickets;
+    release(&ptable.lock);
+    return kept;
+  }
+
+  // Check the amount against the value the current process will have once its children
+  // that hold tickets of their own have returned them to join the currency.
+  value = p->value;
+  for (c = ptable.proc; c < &ptable.proc[NPROC]; c++)
+  {
+    if (c->parent == p && c->issuer == 0 && c->state != UNUSED && c->state != ZOMBIE && p->issuer == 0)
+      value += c->value;
+  }
+  if (tickets < 0 || tickets > value - 1)
+  {
+    release(&ptable.lock);
+    return -2;
+  }
+
+  // Children that hold tickets of their own return them and join at equal face value.
+  for (c = ptable.proc; c < &ptable.proc[NPROC]; c++)
+  {
+    if (c->parent == p && c->issuer == 0 && c->state != UNUSED && c->state != ZOMBIE)
+    {
+      refund(p, c->value);
+      c->issuer = p;
+      c->face = CURRENCY_FACE;
+    }
+  }
+
+  p->fundpm = tickets * 1000 / p->value;
+  if (p->fundpm == 0)
+    p->fundpm = 1;
+  revalue(p);
+
+  kept = p->tickets;
+
+  release(&ptable.lock);
+
+  return kept;
+}
+
+// Function to make the process with 'pid' real-time: every 'period' ticks it may run for
+// 'budget' ticks ahead of all other processes, earliest deadline first. It is admitted on
+// the CPU with the most real-time capacity left, if any CPU can still fit budget/period
+// under RT_MAX_UTIL. A period of 0 takes the process out of the real-time class.
+// Returns 0, or -1 if there is no such process or it cannot be admitted.
+int procs_set_rt(int pid, int period, int budget)
+{
+  struct proc *p;
+  struct cpu *c, *best;
+  int util, used, bestused, move, queued;
+
+  if (period < 0 || period > RT_MAX_PERIOD || (period > 0 && (budget <= 0 || budget > period)))
+    return -1;
+  // Round up, so that every admitted process holds some of its CPU.
+  util = period ? (budget * 1000 + period - 1) / period : 0;
+
+  acquire(&ptable.lock);
+
+  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    if (p->pid == pid && p->state != UNUSED && p->state != ZOMBIE)
+      break;
+  if (p == &ptable.proc[NPROC])
+  {
+    release(&ptable.lock);
+    return -1;
+  }
+
+  // Admission control: find the least-loaded CPU with room, counting
+  // p's current reservation as free.
+  best = 0;
+  bestused = 0;
+  for (c = cpus; c < &cpus[ncpu] && period > 0; c++)
+  {
+    used = c->rtutil - (p->rtperiod && &cpus[p->cpu] == c ? p->rtutil : 0);
+    if (used + util <= RT_MAX_UTIL && (best == 0 || used < bestused))
+    {
+      best = c;
+      bestused = used;
+    }
+  }
+  if (period > 0 && best == 0)
+  {
+    release(&ptable.lock);
+    return -1;
+  }
+
+  rt_leave(p);
+  if (period > 0)
+  {
+    queued = dequeue(p);
+    p->cpu = best - cpus;
+    p->rtperiod = period;
+    p->rtbudget = budget;
+    p->rtutil = util;
+    p->rtdeadline = ticks + period;
+    p->rtused = 0;
+    best->nrt++;
+    best->rtutil += util;
+    if (queued)
+      setrunnable(p);
+  }
+
+  // The caller moves to its real-time CPU right away.
+  move = (p == myproc() && period > 0 && &cpus[p->cpu] != mycpu());
+
+  release(&ptable.lock);
+
+  if (move)
+    yield();
+
+  return 0;
+}
+
+// Function to set the fork policy of process 'p'; its future children inherit it.
+// Returns the previous policy, or -1 if 'policy' is not a fork policy.
+int procs_set_fork_policy(int policy, struct proc *p)
+{
+  int old;
+
+  if (policy != FORK_PARENT_FIRST && policy != FORK_CHILD_FIRST && policy != FORK_ALTERNATE)
+    return -1;
+
+  acquire(&ptable.lock);
+  old = p->forkpolicy;
+  p->forkpolicy = policy;
+  p->nforks = 0;
+  release(&ptable.lock);
+
+  return old;
+}
@@ -1,3 +1,12 @@
+// Run queue of RUNNABLE procs: a min-heap keyed by rqkey (see runq.c).
+struct runq {
+  struct proc *heap[NPROC+1];  // heap[1] is the root
+  int n;                       // Number of queued procs
+  int tree[NPROC+1];           // Fenwick tree of queued tickets by proc slot
+  struct proc *slot[NPROC+1];  // Queued proc in each slot
+  int tickets;                 // Total tickets queued
+};
+
 // Per-CPU state
 struct cpu {
   uchar apicid;                // Local APIC ID
@@ -8,6 +17,19 @@ struct cpu {
   int ncli;                    // Depth of pushcli nesting.
   int intena;                  // Were interrupts enabled before pushcli?
   struct proc *proc;           // The process running on this cpu or null
+  struct runq rq;              // RUNNABLE procs waiting for this cpu
+  struct runq rtq;             // RUNNABLE real-time procs, earliest deadline first
+  int nrt;                     // Real-time procs assigned to this cpu
+  int rtutil;                  // Their budget/period, summed in per-mille
+  uint picks;                  // Scheduler statistics, see schedstat.h
+  uint steals;
+  uint idles;
+  uint seed;                   // Lottery random number generator state
+  volatile int tickless;       // Idle with its timer stopped (see trap.c)
+  uint64 idlestart;            // rdtsc when it stopped its timer
+  uint64 pickcycles;
+  uint64 ticklesscycles;
+  uint skipped;
 };
 
 extern struct cpu cpus[NCPU];
@@ -16,6 +38,26 @@ extern int ncpu;
 extern int procs_tickets_owned(int pid);
 // Function declaration to transfer a specified number of tickets from the current process to a process with the specified 'pid'.
 extern int tickets_transfer(int pid, int tickets, struct proc *p);
+// Function declaration to switch the scheduling policy and re-order the run queues for it.
+extern void sched_set_policy(int policy);
+// Function declaration to take a snapshot of the scheduler statistics.
+struct schedstat;
+extern void sched_get_stats(struct schedstat *st);
+// Function declaration to take a snapshot of the accounting of one process ('pid' > 0) or of all processes.
+struct pstat;
+extern int procs_stats(int pid, struct pstat *ps);
+// Function declaration to set the number of ticks between MLFQ priority boosts.
+extern int mlfq_set_boost(int ticks);
+// Function declaration to set the quantum in ticks of a scheduling policy.
+extern int sched_set_quantum(int policy, int ticks);
+// Function declaration to set the CPUs that the process with the specified 'pid' may run on.
+extern int procs_set_affinity(int pid, uint mask);
+// Function declaration to put a number of the current process's tickets behind a currency that funds its children.
+extern int procs_fund_children(int tickets, struct proc *p);
+// Function declaration to make the process with the specified 'pid' real-time (or not, with a period of 0).
+extern int procs_set_rt(int pid, int period, int budget);
+// Function declaration to set the fork policy of the process 'p'.
+extern int procs_set_fork_policy(int policy, struct proc *p);
 
 //PAGEBREAK: 17
 // Saved registers for kernel context switches.
@@ -49,15 +91,55 @@ struct proc {
   struct trapframe *tf;        // Trap frame for current syscall
   struct context *context;     // swtch() here to run process
   void *chan;                  // If non-zero, sleeping on chan
+  struct proc *wnext;          // Next proc sleeping in the same wait queue
   int killed;                  // If non-zero, have been killed
   struct file *ofile[NOFILE];  // Open files
   struct inode *cwd;           // Current directory
   char name[16];               // Process name (debugging)
   int tickets;		       // Number of tickets assigned to this process for scheduling.
+  int value;		       // Tickets it is worth, including those behind its currency.
+  struct proc *issuer;	       // Process whose currency funds it, or 0 if it holds its own tickets.
+  int face;		       // Its tickets in the issuer's currency.
+  int fundpm;		       // Per-mille of its value behind the currency funding its children.
+  uint comp;		       // Compensation owed for the unused part of a quantum (stride).
+  int rtperiod;		       // Real-time period in ticks, 0 if not real-time.
+  int rtbudget;		       // Real-time budget in ticks per period.
+  int rtutil;		       // budget/period in per-mille, as admitted.
+  uint rtdeadline;	       // Tick at which the current period ends.
+  int rtused;		       // Ticks of the budget used in the current period.
+  int rtthrottled;	       // Budget used up; not queued until the next period.
   int strides;		       // Stride value calculated based on the number of tickets.
-  int pass;		       // Indicates how much "time" this process has consumed in scheduling.
+  uint64 pass;		       // Indicates how much "time" this process has consumed in scheduling.
+  uint64 rqkey;		       // Run queue order: pass for stride, arrival for round robin.
+  int rqidx;		       // Slot in the run queue heap, 0 if not queued.
+  int cpu;		       // CPU whose run queue holds (or last ran) this process.
+  int slot;		       // Index in the process table, from 1; set by pinit().
+  uint affinity;	       // CPUs this process may run on, bit i for cpus[i].
+  int forkpolicy;	       // FORK_PARENT_FIRST, FORK_CHILD_FIRST or FORK_ALTERNATE.
+  uint nforks;		       // Forks made, for FORK_ALTERNATE.
+  int level;		       // MLFQ level, 0 is the highest priority.
+  int qticks;		       // Ticks used of the quantum at this MLFQ level.
+  uint runticks;	       // Timer ticks taken while running.
+  uint nsched;		       // Times dispatched by the scheduler.
+  uint nswitch;		       // Times it gave up the CPU through sched() ...
+  uint npreempt;	       // ... of which were timer preemptions.
+  uint64 runcycles;	       // rdtsc cycles spent running.
+  uint64 waitcycles;	       // rdtsc cycles spent RUNNABLE in a run queue.
+  uint64 stamp;		       // rdtsc when it was last queued or dispatched.
 };
 
+// Scheduling policies selected with set_sched().
+#define SCHED_RR      0
+#define SCHED_STRIDE  1
+#define SCHED_LOTTERY 2
+#define SCHED_MLFQ    3
+
+#define MLFQ_LEVELS   4   // Multi-level feedback queue levels, 0 is the highest
+
+// Passes and run queue keys only grow, so compare them through the signed
+// difference; the order stays correct even if a value ever wraps around.
+#define PASS_LT(a, b) ((long long)((a) - (b)) < 0)
+
 // Process memory is laid out contiguously, low addresses first:
 //   text
 //   original data and bss
@@ -0,0 +1,27 @@
+// Per-process scheduler accounting copied out by getprocstats().
+// Cycle counts are rdtsc() deltas taken in scheduler() and sched().
+
+// procstat.state values, the same as enum procstate in proc.h.
+#define PS_UNUSED   0
+#define PS_EMBRYO   1
+#define PS_SLEEPING 2
+#define PS_RUNNABLE 3
+#define PS_RUNNING  4
+#define PS_ZOMBIE   5
+
+struct procstat {
+  int pid;
+  int state;             // PS_*
+  int tickets;
+  uint runticks;         // Timer ticks taken while running
+  uint nsched;           // Times dispatched by the scheduler
+  uint nvoluntary;       // Gave up the CPU by sleeping or calling yield()
+  uint ninvoluntary;     // Preempted by the timer
+  uint64 runcycles;      // Cycles spent running
+  uint64 waitcycles;     // Cycles spent RUNNABLE in a run queue
+};
+
+struct pstat {
+  int nproc;                   // Entries filled in proc[]
+  struct procstat proc[NPROC];
+};
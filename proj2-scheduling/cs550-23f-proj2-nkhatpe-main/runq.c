@@ -0,0 +1,188 @@
+// Run queue of RUNNABLE processes.
+//
+// A binary min-heap ordered by rqkey, so the scheduler can pick
+// the next process in O(log n) instead of scanning the whole
+// process table.  The key is the stride pass under the stride
+// policy and an arrival sequence number under round robin, which
+// makes the heap a FIFO.  heap[1] is the root; a proc's rqidx is
+// its slot in the heap, or 0 when it is not queued.
+//
+// Alongside the heap, a Fenwick tree indexed by process table slot
+// sums the tickets of the queued procs, so the lottery policy can
+// draw a winner in O(log n).  Whoever changes the tickets of a
+// queued proc must tell the tree through runqweight().
+//
+// Each CPU has its own run queues; the caller must hold their lock
+// (see runqlock in proc.c), except for runqpeek().
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "x86.h"
+#include "proc.h"
+
+static void
+swap(struct runq *rq, int i, int j)
+{
+  struct proc *p;
+
+  p = rq->heap[i];
+  rq->heap[i] = rq->heap[j];
+  rq->heap[j] = p;
+  rq->heap[i]->rqidx = i;
+  rq->heap[j]->rqidx = j;
+}
+
+// Add delta to the tickets of slot i.
+static void
+fwadd(struct runq *rq, int i, int delta)
+{
+  for(; i <= NPROC; i += i & -i)
+    rq->tree[i] += delta;
+  rq->tickets += delta;
+}
+
+static void
+siftup(struct runq *rq, int i)
+{
+  while(i > 1 && PASS_LT(rq->heap[i]->rqkey, rq->heap[i/2]->rqkey)){
+    swap(rq, i, i/2);
+    i /= 2;
+  }
+}
+
+static void
+siftdown(struct runq *rq, int i)
+{
+  int c;
+
+  for(;;){
+    c = 2*i;
+    if(c > rq->n)
+      break;
+    if(c+1 <= rq->n && PASS_LT(rq->heap[c+1]->rqkey, rq->heap[c]->rqkey))
+      c++;
+    if(!PASS_LT(rq->heap[c]->rqkey, rq->heap[i]->rqkey))
+      break;
+    swap(rq, i, c);
+    i = c;
+  }
+}
+
+// Add p to the run queue.
+void
+runqinsert(struct runq *rq, struct proc *p)
+{
+  if(p->rqidx != 0 || rq->n >= NPROC)
+    panic("runqinsert");
+  rq->n++;
+  rq->heap[rq->n] = p;
+  p->rqidx = rq->n;
+  siftup(rq, rq->n);
+  rq->slot[p->slot] = p;
+  fwadd(rq, p->slot, p->tickets);
+}
+
+// Add p to the front of the run queue, ahead of everything queued:
+// its key becomes one below the current minimum.
+void
+runqpush(struct runq *rq, struct proc *p)
+{
+  struct proc *q;
+
+  if((q = runqmin(rq)) != 0 && !PASS_LT(p->rqkey, q->rqkey))
+    p->rqkey = q->rqkey - 1;
+  runqinsert(rq, p);
+}
+
+// Take p off the run queue, wherever it is in the heap.
+void
+runqremove(struct runq *rq, struct proc *p)
+{
+  int i;
+
+  i = p->rqidx;
+  if(i == 0 || rq->heap[i] != p)
+    panic("runqremove");
+  p->rqidx = 0;
+  rq->slot[p->slot] = 0;
+  fwadd(rq, p->slot, -p->tickets);
+  if(i == rq->n){
+    rq->n--;
+    return;
+  }
+  rq->heap[i] = rq->heap[rq->n];
+  rq->heap[i]->rqidx = i;
+  rq->n--;
+  siftdown(rq, i);
+  siftup(rq, i);
+}
+
+// Remove and return the proc with the smallest key,
+// or 0 if the run queue is empty.
+struct proc*
+runqpop(struct runq *rq)
+{
+  struct proc *p;
+
+  if(rq->n == 0)
+    return 0;
+  p = rq->heap[1];
+  runqremove(rq, p);
+  return p;
+}
+
+// Return the proc with the smallest key without removing it,
+// or 0 if the run queue is empty.
+struct proc*
+runqmin(struct runq *rq)
+{
+  if(rq->n == 0)
+    return 0;
+  return rq->heap[1];
+}
+
+// Like runqmin(), for a caller that does not hold the run queue's lock.
+// The answer is only a hint, possibly out of date, to be checked again
+// under the lock before acting on it.
+struct proc*
+runqpeek(struct runq *rq)
+{
+  if(*(volatile int*)&rq->n == 0)
+    return 0;
+  return *(struct proc* volatile*)&rq->heap[1];
+}
+
+// Queued p's tickets are about to change by delta.
+void
+runqweight(struct runq *rq, struct proc *p, int delta)
+{
+  if(p->rqidx == 0 || rq->slot[p->slot] != p)
+    panic("runqweight");
+  fwadd(rq, p->slot, delta);
+}
+
+// Return the proc holding ticket number r, counting the tickets of
+// the queued procs in slot order; r must be below rq->tickets.
+// Does not remove it.
+struct proc*
+runqdraw(struct runq *rq, uint r)
+{
+  int i, step;
+
+  if(r >= rq->tickets)
+    panic("runqdraw");
+  for(step = 1; 2*step <= NPROC; step *= 2)
+    ;
+  // Find the last slot whose prefix sum is still at most r.
+  i = 0;
+  for(; step > 0; step /= 2){
+    if(i + step <= NPROC && rq->tree[i + step] <= r){
+      i += step;
+      r -= rq->tree[i];
+    }
+  }
+  return rq->slot[i + 1];
+}
@@ -1,11 +1,25 @@
 #include "types.h"
+#include "param.h"
+#include "pstat.h"
 #include "user.h"
 
 #define P_LOOP_CNT 0x10000000
 #define C_LOOP_CNT 0x20000000
 
+#define FAIR_CHILDREN 3
+#define FAIR_TICKS    1000000  // default length of the fairness benchmark
+#define FAIR_CHUNK    0x10000  // loop iterations between uptime() checks
+#define VAR_TRIALS    8        // trials per policy in the variance benchmark
+#define VAR_TICKS     200      // default length of each variance trial
+#define CUR_TICKS     500      // default length of the currency benchmark
+#define RT_TICKS      500      // default length of the real-time benchmark
+#define RT_TASKS      5
+#define RT_HOGS       3
+
 unsigned int avoid_optm = 0; // a variable used to avoid compiler optimization
 
+struct pstat fair_stats;     // kernel accounting snapshot taken by the fairness test
+
 void do_parent(void)
 {
     unsigned int cnt = 0;
@@ -78,8 +92,482 @@ void run_test_case(const char *test_name, int scheduler_type)
     printf(1, "\n");
 }
 
+// Print a per-mille value as a percentage with one decimal.
+void print_permille(int pm)
+{
+    printf(1, "%d.%d%%", pm / 10, pm % 10);
+}
+
+// Print each process's share of the run time the kernel charged to the
+// given pids, with its dispatch and switch counts and average run queue wait.
+void print_kernel_shares(int *pids, int n, struct pstat *ps)
+{
+    struct procstat *st[NPROC];
+    uint64 total = 0;
+    int i, k, shift = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        st[i] = 0;
+        for (k = 0; k < ps->nproc; k++)
+        {
+            if (ps->proc[k].pid == pids[i])
+            {
+                st[i] = &ps->proc[k];
+                total += st[i]->runcycles;
+            }
+        }
+    }
+
+    // Scale the cycle counts down so that the per-mille math fits in 32 bits.
+    while ((total >> shift) > 1000000)
+    {
+        shift++;
+    }
+    if ((total >> shift) == 0)
+    {
+        printf(1, "no run time recorded\n");
+        return;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        if (st[i] == 0)
+        {
+            continue;
+        }
+        printf(1, "pid %d: kernel run share ", pids[i]);
+        print_permille((uint)(st[i]->runcycles >> shift) * 1000 / (uint)(total >> shift));
+        printf(1, ", %d ticks, %d dispatches, %d voluntary / %d involuntary switches, %d Kcycles avg wait\n",
+               st[i]->runticks, st[i]->nsched, st[i]->nvoluntary, st[i]->ninvoluntary,
+               st[i]->nsched ? (uint)(st[i]->waitcycles >> 10) / st[i]->nsched : 0);
+    }
+}
+
+// Fork FAIR_CHILDREN CPU-bound children under the given policy and let them
+// spin for 'ticks' timer ticks. Children are funded by halving the parent's
+// tickets, so they hold roughly 4:2:1. Fills in each child's pid, tickets and
+// work done (chunks, scaled down so that per-mille math cannot overflow) and,
+// if ps is not null, a kernel accounting snapshot taken before they are
+// reaped. Returns the total of the scaled chunks.
+uint share_run(int policy, int ticks, int *pids, int *tickets, uint *chunks, struct pstat *ps)
+{
+    uint total_chunks = 0;
+    int start[2], done[2];
+    int i, j, end;
+
+    set_sched(policy);
+
+    if (pipe(start) < 0 || pipe(done) < 0)
+    {
+        printf(1, "pipe() failed\n");
+        exit();
+    }
+
+    for (i = 0; i < FAIR_CHILDREN; i++)
+    {
+        pids[i] = fork();
+        if (pids[i] < 0)
+        {
+            printf(1, "fork() failed\n");
+            exit();
+        }
+        if (pids[i] == 0)
+        {
+            uint n = 0;
+            unsigned int tmp = 0;
+
+            read(start[0], &end, sizeof(end));
+            while (uptime() < end)
+            {
+                for (j = 0; j < FAIR_CHUNK; j++)
+                {
+                    tmp += j;
+                }
+                n++;
+            }
+            avoid_optm = tmp;
+
+            write(done[1], &i, sizeof(i));
+            write(done[1], &n, sizeof(n));
+            exit();
+        }
+    }
+
+    for (i = 0; i < FAIR_CHILDREN; i++)
+    {
+        tickets[i] = tickets_owned(pids[i]);
+    }
+
+    end = uptime() + ticks;
+    for (i = 0; i < FAIR_CHILDREN; i++)
+    {
+        write(start[1], &end, sizeof(end));
+    }
+
+    for (i = 0; i < FAIR_CHILDREN; i++)
+    {
+        read(done[0], &j, sizeof(j));
+        read(done[0], &chunks[j], sizeof(chunks[j]));
+    }
+
+    // Snapshot the kernel's accounting before the children are reaped.
+    if (ps)
+    {
+        getprocstats(0, ps);
+    }
+    for (i = 0; i < FAIR_CHILDREN; i++)
+    {
+        wait();
+    }
+
+    close(start[0]);
+    close(start[1]);
+    close(done[0]);
+    close(done[1]);
+
+    // Scale the counts down so that the per-mille math cannot overflow.
+    for (i = 0; i < FAIR_CHILDREN; i++)
+    {
+        total_chunks += chunks[i];
+    }
+    while (total_chunks > 1000000)
+    {
+        total_chunks = 0;
+        for (i = 0; i < FAIR_CHILDREN; i++)
+        {
+            chunks[i] /= 2;
+            total_chunks += chunks[i];
+        }
+    }
+
+    return total_chunks;
+}
+
+// Long-running stride fairness benchmark: the observed CPU share of each
+// child is compared with its ticket share.
+void fairness_test(int ticks)
+{
+    int pids[FAIR_CHILDREN];
+    int tickets[FAIR_CHILDREN];
+    uint chunks[FAIR_CHILDREN];
+    uint total_chunks;
+    int total_tickets = 0;
+    int i;
+
+    printf(1, "Fairness: stride scheduler, %d children, %d ticks\n", FAIR_CHILDREN, ticks);
+
+    total_chunks = share_run(1, ticks, pids, tickets, chunks, &fair_stats);
+    for (i = 0; i < FAIR_CHILDREN; i++)
+    {
+        total_tickets += tickets[i];
+    }
+    if (total_chunks == 0 || total_tickets == 0)
+    {
+        printf(1, "no work recorded\n");
+        return;
+    }
+
+    for (i = 0; i < FAIR_CHILDREN; i++)
+    {
+        printf(1, "Child%d (pid %d): %d tickets, ticket share ", i + 1, pids[i], tickets[i]);
+        print_permille(tickets[i] * 1000 / total_tickets);
+        printf(1, ", CPU share ");
+        print_permille(chunks[i] * 1000 / total_chunks);
+        printf(1, "\n");
+    }
+
+    print_kernel_shares(pids, FAIR_CHILDREN, &fair_stats);
+}
+
+// Run VAR_TRIALS short trials under each policy and compare how closely and
+// how consistently each child's CPU share follows its ticket share. Shares
+// are in per-mille; the error is the mean squared difference from the ticket
+// share and the variance is each child's spread across trials, averaged.
+void variance_test(int ticks)
+{
+    static char *names[] = { "round robin", "stride", "lottery" };
+    int pids[FAIR_CHILDREN];
+    int tickets[FAIR_CHILDREN];
+    uint chunks[FAIR_CHILDREN];
+    int share[VAR_TRIALS][FAIR_CHILDREN];
+    int ticketshare[FAIR_CHILDREN];
+    uint total_chunks;
+    int policy, t, i, total_tickets, mean, d;
+    uint error, variance;
+
+    printf(1, "Variance: %d children, %d trials of %d ticks per policy\n", FAIR_CHILDREN, VAR_TRIALS, ticks);
+
+    for (policy = 0; policy <= 2; policy++)
+    {
+        for (t = 0; t < VAR_TRIALS; t++)
+        {
+            total_chunks = share_run(policy, ticks, pids, tickets, chunks, 0);
+            total_tickets = 0;
+            for (i = 0; i < FAIR_CHILDREN; i++)
+            {
+                total_tickets += tickets[i];
+            }
+            for (i = 0; i < FAIR_CHILDREN; i++)
+            {
+                share[t][i] = total_chunks ? chunks[i] * 1000 / total_chunks : 0;
+                ticketshare[i] = total_tickets ? tickets[i] * 1000 / total_tickets : 0;
+            }
+        }
+
+        error = 0;
+        variance = 0;
+        for (i = 0; i < FAIR_CHILDREN; i++)
+        {
+            mean = 0;
+            for (t = 0; t < VAR_TRIALS; t++)
+            {
+                mean += share[t][i];
+                d = share[t][i] - ticketshare[i];
+                error += d * d;
+            }
+            mean /= VAR_TRIALS;
+            for (t = 0; t < VAR_TRIALS; t++)
+            {
+                d = share[t][i] - mean;
+                variance += d * d;
+            }
+        }
+        printf(1, "%s: mean squared error vs ticket share %d, variance across trials %d (per-mille^2)\n",
+               names[policy], error / (VAR_TRIALS * FAIR_CHILDREN), variance / (VAR_TRIALS * FAIR_CHILDREN));
+    }
+
+    set_sched(0);
+}
+
+// Spin until uptime() reaches 'end'.
+void spin_until(int end)
+{
+    unsigned int tmp = 0;
+    int j;
+
+    while (uptime() < end)
+    {
+        for (j = 0; j < FAIR_CHUNK; j++)
+        {
+            tmp += j;
+        }
+    }
+    avoid_optm = tmp;
+}
+
+// Ticket currency benchmark: the parent puts half of its tickets behind a
+// currency for its three children, which share it equally. The third child
+// puts half of its own share behind a currency for two grandchildren, so
+// the expected split of the pool is 1/3, 1/3, 1/6, 1/12, 1/12. Everyone
+// spins while the parent sleeps, then the tickets and the kernel-measured
+// run shares are printed.
+void currency_test(int ticks)
+{
+    int pids[NPROC];
+    int i, n, end, kept;
+
+    printf(1, "Currency: stride scheduler, 3 children and 2 grandchildren, %d ticks\n", ticks);
+
+    set_sched(1);
+
+    kept = fund_children(tickets_owned(getpid()) / 2);
+    printf(1, "Parent (pid %d) keeps %d tickets\n", getpid(), kept);
+
+    end = uptime() + ticks;
+    for (i = 0; i < 3; i++)
+    {
+        int pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork() failed\n");
+            exit();
+        }
+        if (pid == 0)
+        {
+            if (i == 2)
+            {
+                fund_children(tickets_owned(getpid()) / 2);
+                if (fork() == 0)
+                {
+                    spin_until(end);
+                    exit();
+                }
+                if (fork() == 0)
+                {
+                    spin_until(end);
+                    exit();
+                }
+                spin_until(end);
+                wait();
+                wait();
+            }
+            else
+            {
+                spin_until(end);
+            }
+            exit();
+        }
+    }
+
+    // Snapshot the accounting shortly before the spinners finish.
+    sleep(ticks - 10 > 0 ? ticks - 10 : 1);
+    getprocstats(0, &fair_stats);
+
+    n = 0;
+    for (i = 0; i < fair_stats.nproc; i++)
+    {
+        if (fair_stats.proc[i].pid > getpid() && fair_stats.proc[i].state != PS_ZOMBIE)
+        {
+            pids[n++] = fair_stats.proc[i].pid;
+            printf(1, "pid %d: %d tickets\n", fair_stats.proc[i].pid, fair_stats.proc[i].tickets);
+        }
+    }
+    print_kernel_shares(pids, n, &fair_stats);
+
+    for (i = 0; i < 3; i++)
+    {
+        wait();
+    }
+    fund_children(0);
+}
+
+// Real-time benchmark: five periodic tasks with a total utilization of
+// about 0.69 share the machine with CPU-bound hogs. Each job is released
+// at the start of its period, does about half its budget of work and
+// must finish before the period ends; late jobs are counted as misses.
+int rt_period[RT_TASKS] = {10, 20, 25, 50, 40};
+int rt_budget[RT_TASKS] = {2, 3, 4, 5, 3};
+
+void rt_test(int ticks)
+{
+    unsigned int tmp = 0;
+    uint chunks, per_tick, work, w;
+    int i, j, t, end, start, release, res[3], fd[2];
+
+    printf(1, "Real-time: %d EDF tasks and %d hogs, %d ticks\n", RT_TASKS, RT_HOGS, ticks);
+
+    if (set_rt(getpid(), 10, 11) != -1)
+    {
+        printf(1, "set_rt accepted a budget longer than its period\n");
+    }
+
+    // Measure how much work fits in a tick on an idle machine.
+    t = uptime() + 1;
+    while (uptime() < t)
+        ;
+    chunks = 0;
+    while (uptime() < t + 10)
+    {
+        for (j = 0; j < FAIR_CHUNK; j++)
+        {
+            tmp += j;
+        }
+        chunks++;
+    }
+    per_tick = chunks / 10 > 0 ? chunks / 10 : 1;
+
+    end = uptime() + ticks;
+    for (i = 0; i < RT_HOGS; i++)
+    {
+        if (fork() == 0)
+        {
+            spin_until(end);
+            exit();
+        }
+    }
+
+    pipe(fd);
+    for (i = 0; i < RT_TASKS; i++)
+    {
+        if (fork() == 0)
+        {
+            close(fd[0]);
+            if (set_rt(getpid(), rt_period[i], rt_budget[i]) < 0)
+            {
+                res[0] = i;
+                res[1] = res[2] = -1;
+                write(fd[1], res, sizeof(res));
+                exit();
+            }
+            work = per_tick * rt_budget[i] / 2;
+            res[0] = i;
+            res[1] = res[2] = 0;
+            start = uptime();
+            for (release = start; release + rt_period[i] <= end; release += rt_period[i])
+            {
+                if (uptime() < release)
+                {
+                    sleep(release - uptime());
+                }
+                for (w = 0; w < work; w++)
+                {
+                    for (j = 0; j < FAIR_CHUNK; j++)
+                    {
+                        tmp += j;
+                    }
+                }
+                res[1]++;
+                if (uptime() > release + rt_period[i])
+                {
+                    res[2]++;
+                }
+            }
+            avoid_optm = tmp;
+            write(fd[1], res, sizeof(res));
+            exit();
+        }
+    }
+    close(fd[1]);
+
+    // Each task reports its index, jobs and misses in one write.
+    for (i = 0; i < RT_TASKS; i++)
+    {
+        if (read(fd[0], res, sizeof(res)) != sizeof(res))
+        {
+            break;
+        }
+        j = res[0];
+        if (res[1] < 0)
+        {
+            printf(1, "task %d (%d/%d): not admitted: FAIL\n", j, rt_budget[j], rt_period[j]);
+            continue;
+        }
+        printf(1, "task %d (%d/%d): %d jobs, %d missed deadlines: %s\n", j, rt_budget[j], rt_period[j],
+               res[1], res[2], res[1] > 0 && res[2] == 0 ? "PASS" : "FAIL");
+    }
+    close(fd[0]);
+
+    for (i = 0; i < RT_TASKS + RT_HOGS; i++)
+    {
+        wait();
+    }
+    avoid_optm = tmp;
+}
+
 int main(int argc, char *argv[])
 {
+    if (argc >= 2 && strcmp(argv[1], "fair") == 0)
+    {
+        fairness_test(argc >= 3 ? atoi(argv[2]) : FAIR_TICKS);
+        exit();
+    }
+    if (argc >= 2 && strcmp(argv[1], "currency") == 0)
+    {
+        currency_test(argc >= 3 ? atoi(argv[2]) : CUR_TICKS);
+        exit();
+    }
+    if (argc >= 2 && strcmp(argv[1], "rt") == 0)
+    {
+        rt_test(argc >= 3 ? atoi(argv[2]) : RT_TICKS);
+        exit();
+    }
+    if (argc >= 2 && strcmp(argv[1], "variance") == 0)
+    {
+        variance_test(argc >= 3 ? atoi(argv[2]) : VAR_TICKS);
+        exit();
+    }
+
     enable_sched_trace(1);
 
     /* ---------------- start: add your test code ------------------- */
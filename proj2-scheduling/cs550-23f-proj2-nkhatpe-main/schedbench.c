@@ -0,0 +1,616 @@
+#include "types.h"
+#include "param.h"
+#include "schedstat.h"
+#include "user.h"
+
+// Scheduler microbenchmarks.
+//
+//   schedbench switch    context switches per second with 4, 16 and 60
+//                        runnable processes under each policy
+//   schedbench scale     throughput of 1, 2, 4 and 8 CPU-bound processes
+//                        under each policy and how long ptable.lock is
+//                        held per acquisition;
+//                        run with "make qemu-nox CPUS=4" to see the scaling
+//   schedbench idle      scheduler passes, time spent with the timer stopped
+//                        and ticks skipped per CPU while the system idles
+//                        until Enter is pressed; it waits on the console,
+//                        not on ticks, so even CPU 0 can stop its timer
+//   schedbench slice [ticks]
+//                        context switches of 2 CPU-bound processes under
+//                        stride with a quantum of 1 and of 'ticks' (default 10)
+//   schedbench latency [hogs]
+//                        pipe ping-pong round trip time while 0, 2 and 8
+//                        (or the given number of) CPU hogs run
+//   schedbench affinity  throughput of memory-touching workers, two per CPU,
+//                        each pinned to one CPU vs. free to run anywhere
+//   schedbench lock      ptable.lock acquisitions and hold time during a
+//                        pipe ping-pong and during stressfs
+//   schedbench fork [hogs]
+//                        fork/exit/wait round trip time under each fork
+//                        policy while 4 (or the given number of) CPU hogs run
+
+#define SCHEDULER_DEFAULT 0
+#define SCHEDULER_STRIDE  1
+#define SCHEDULER_LOTTERY 2
+#define SCHEDULER_MLFQ    3
+
+#define TICKS_PER_SEC 100      // timer interrupts per second (lapic.c)
+#define SWITCH_TOTAL  120000   // yields per run, split across the children
+#define SCALE_WORK    (1 << 30) // loop iterations per run, split across the children
+#define PINGPONGS     200      // round trips per latency run
+#define SLICE_WORK    (1 << 29) // loop iterations per slice run, split across the children
+#define AFF_BYTES     (64 * 1024) // memory each affinity worker keeps touching
+#define AFF_PASSES    4000     // passes over that memory per worker
+#define FORKS         100      // fork/wait round trips per fork policy
+
+static inline uint64 rdtsc(void)
+{
+    uint lo, hi;
+
+    asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64)hi << 32) | lo;
+}
+
+// Fork n children that block on the start pipe and then each call yield()
+// loops times. Returns the number of ticks from the start signal until the
+// last child has been reaped.
+int run_yielders(int n, int loops)
+{
+    int i, j;
+    int fd[2];
+    char c;
+    int t0, t1;
+
+    if (pipe(fd) < 0)
+    {
+        printf(1, "pipe() failed\n");
+        exit();
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        int pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork() failed\n");
+            exit();
+        }
+        if (pid == 0)
+        {
+            close(fd[1]);
+            read(fd[0], &c, 1);
+            for (j = 0; j < loops; j++)
+            {
+                yield();
+            }
+            exit();
+        }
+    }
+
+    close(fd[0]);
+    t0 = uptime();
+    for (i = 0; i < n; i++)
+    {
+        write(fd[1], "x", 1);
+    }
+    close(fd[1]);
+
+    for (i = 0; i < n; i++)
+    {
+        wait();
+    }
+    t1 = uptime();
+
+    return t1 - t0;
+}
+
+void bench_switch(void)
+{
+    static int nprocs[] = { 4, 16, 60 };
+    static char *names[] = { "round robin", "stride", "lottery", "mlfq" };
+    int policy, i, n, loops, ticks;
+
+    for (policy = SCHEDULER_DEFAULT; policy <= SCHEDULER_MLFQ; policy++)
+    {
+        set_sched(policy);
+        for (i = 0; i < sizeof(nprocs) / sizeof(nprocs[0]); i++)
+        {
+            n = nprocs[i];
+            loops = SWITCH_TOTAL / n;
+            ticks = run_yielders(n, loops);
+            if (ticks <= 0)
+            {
+                ticks = 1;
+            }
+            printf(1, "%s: %d runnable, %d switches in %d ticks, %d switches/sec\n",
+                   names[policy], n, n * loops, ticks, n * loops / ticks * TICKS_PER_SEC);
+        }
+    }
+    set_sched(SCHEDULER_DEFAULT);
+}
+
+// Fork n children that block on the start pipe and then each spin for
+// work iterations. Returns the number of ticks from the start signal until
+// the last child has been reaped.
+int run_spinners(int n, int work)
+{
+    int i, j;
+    int fd[2];
+    char c;
+    int t0, t1;
+    volatile int sink = 0;
+
+    if (pipe(fd) < 0)
+    {
+        printf(1, "pipe() failed\n");
+        exit();
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        int pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork() failed\n");
+            exit();
+        }
+        if (pid == 0)
+        {
+            close(fd[1]);
+            read(fd[0], &c, 1);
+            for (j = 0; j < work; j++)
+            {
+                sink += j;
+            }
+            exit();
+        }
+    }
+
+    close(fd[0]);
+    t0 = uptime();
+    for (i = 0; i < n; i++)
+    {
+        write(fd[1], "x", 1);
+    }
+    close(fd[1]);
+
+    for (i = 0; i < n; i++)
+    {
+        wait();
+    }
+    t1 = uptime();
+
+    return t1 - t0;
+}
+
+// Cycles per event without 64-bit division (there is no libgcc to do it).
+uint per_event(uint64 cycles, uint events)
+{
+    while (cycles >> 32)
+    {
+        cycles >>= 1;
+        events >>= 1;
+    }
+    if (events == 0)
+    {
+        return 0;
+    }
+    return (uint)cycles / events;
+}
+
+void bench_scale(void)
+{
+    static int nprocs[] = { 1, 2, 4, 8 };
+    static char *names[] = { "round robin", "stride", "lottery", "mlfq" };
+    struct schedstat before, after;
+    int policy, i, k, n, ticks;
+    uint acquires, steals, picks;
+
+    get_sched_stats(&before);
+    printf(1, "%d cpus\n", before.ncpu);
+
+    for (policy = SCHEDULER_DEFAULT; policy <= SCHEDULER_MLFQ; policy++)
+    {
+        set_sched(policy);
+        for (i = 0; i < sizeof(nprocs) / sizeof(nprocs[0]); i++)
+        {
+            n = nprocs[i];
+            get_sched_stats(&before);
+            ticks = run_spinners(n, SCALE_WORK / n);
+            get_sched_stats(&after);
+            if (ticks <= 0)
+            {
+                ticks = 1;
+            }
+
+            picks = 0;
+            steals = 0;
+            for (k = 0; k < after.ncpu; k++)
+            {
+                picks += after.cpu[k].picks - before.cpu[k].picks;
+                steals += after.cpu[k].steals - before.cpu[k].steals;
+            }
+            acquires = after.lockacquires - before.lockacquires;
+
+            printf(1, "%s: %d procs, %d ticks, %d Kiter/tick, lock held %d cycles/acquire, %d picks, %d steals\n",
+                   names[policy], n, ticks, (SCALE_WORK >> 10) / ticks,
+                   per_event(after.lockcycles - before.lockcycles, acquires), picks, steals);
+        }
+    }
+    set_sched(SCHEDULER_DEFAULT);
+}
+
+// Fork n workers that each allocate AFF_BYTES and write every cache line
+// of it AFF_PASSES times, pinned round-robin to the ncpu CPUs if pinned is
+// set. Returns the number of ticks until the last worker has been reaped.
+int run_touchers(int n, int ncpu, int pinned)
+{
+    int i, j, k;
+    int fd[2];
+    char c;
+    int t0, t1;
+    char *buf;
+
+    if (pipe(fd) < 0)
+    {
+        printf(1, "pipe() failed\n");
+        exit();
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        int pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork() failed\n");
+            exit();
+        }
+        if (pid == 0)
+        {
+            close(fd[1]);
+            setaffinity(getpid(), pinned ? 1 << (i % ncpu) : (1 << ncpu) - 1);
+            buf = malloc(AFF_BYTES);
+            memset(buf, 0, AFF_BYTES);
+            read(fd[0], &c, 1);
+            for (j = 0; j < AFF_PASSES; j++)
+            {
+                for (k = 0; k < AFF_BYTES; k += 64)
+                {
+                    buf[k]++;
+                }
+            }
+            exit();
+        }
+    }
+
+    close(fd[0]);
+    t0 = uptime();
+    for (i = 0; i < n; i++)
+    {
+        write(fd[1], "x", 1);
+    }
+    close(fd[1]);
+
+    for (i = 0; i < n; i++)
+    {
+        wait();
+    }
+    t1 = uptime();
+
+    return t1 - t0;
+}
+
+void bench_affinity(void)
+{
+    static char *modes[] = { "unpinned", "pinned" };
+    struct schedstat st;
+    int pinned, n, ticks;
+
+    get_sched_stats(&st);
+    n = 2 * st.ncpu;
+    for (pinned = 0; pinned <= 1; pinned++)
+    {
+        ticks = run_touchers(n, st.ncpu, pinned);
+        if (ticks <= 0)
+        {
+            ticks = 1;
+        }
+        printf(1, "%s: %d workers on %d cpus, %d ticks, %d KB touched/tick\n", modes[pinned], n, st.ncpu,
+               ticks, n * AFF_PASSES / ticks * (AFF_BYTES / 1024));
+    }
+}
+
+void bench_idle(void)
+{
+    struct schedstat before, after;
+    int k, t0;
+    char c;
+
+    // Sleeping on ticks would keep CPU 0's timer running (see
+    // canstoptimer()), so block on the console instead.
+    printf(1, "idling; press Enter to stop\n");
+    get_sched_stats(&before);
+    t0 = uptime();
+    while (read(0, &c, 1) == 1 && c != '\n')
+        ;
+    get_sched_stats(&after);
+
+    printf(1, "idle for %d ticks:\n", uptime() - t0);
+    for (k = 0; k < after.ncpu; k++)
+    {
+        printf(1, "cpu%d: %d idle passes, %d picks, %d Mcycles tickless, %d ticks skipped\n", k,
+               after.cpu[k].idles - before.cpu[k].idles, after.cpu[k].picks - before.cpu[k].picks,
+               (uint)((after.cpu[k].ticklesscycles - before.cpu[k].ticklesscycles) >> 20),
+               after.cpu[k].skipped - before.cpu[k].skipped);
+    }
+}
+
+void bench_slice(int quantum)
+{
+    int quanta[2];
+    struct schedstat before, after;
+    int i, k, ticks, old;
+    uint picks;
+
+    quanta[0] = 1;
+    quanta[1] = quantum;
+    set_sched(SCHEDULER_STRIDE);
+    for (i = 0; i < 2; i++)
+    {
+        old = set_quantum(SCHEDULER_STRIDE, quanta[i]);
+        get_sched_stats(&before);
+        ticks = run_spinners(2, SLICE_WORK / 2);
+        get_sched_stats(&after);
+        set_quantum(SCHEDULER_STRIDE, old);
+
+        picks = 0;
+        for (k = 0; k < after.ncpu; k++)
+        {
+            picks += after.cpu[k].picks - before.cpu[k].picks;
+        }
+        printf(1, "stride, quantum %d: %d ticks, %d picks\n", quanta[i], ticks, picks);
+    }
+    set_sched(SCHEDULER_DEFAULT);
+}
+
+// Bounce a byte between this process and a child over two pipes PINGPONGS
+// times while hogs CPU-bound processes run. Prints the average and worst
+// round trip in Kcycles and the total in ticks.
+void run_pingpong(char *name, int hogs)
+{
+    int hog[NPROC];
+    int ping[2], pong[2];
+    int i, pid, t0;
+    uint64 start, rtt, total, worst;
+    char c = 'x';
+
+    for (i = 0; i < hogs; i++)
+    {
+        hog[i] = fork();
+        if (hog[i] < 0)
+        {
+            printf(1, "fork() failed\n");
+            exit();
+        }
+        if (hog[i] == 0)
+        {
+            for (;;)
+                ;
+        }
+    }
+
+    if (pipe(ping) < 0 || pipe(pong) < 0)
+    {
+        printf(1, "pipe() failed\n");
+        exit();
+    }
+    pid = fork();
+    if (pid < 0)
+    {
+        printf(1, "fork() failed\n");
+        exit();
+    }
+    if (pid == 0)
+    {
+        for (i = 0; i < PINGPONGS; i++)
+        {
+            read(ping[0], &c, 1);
+            write(pong[1], &c, 1);
+        }
+        exit();
+    }
+
+    total = 0;
+    worst = 0;
+    t0 = uptime();
+    for (i = 0; i < PINGPONGS; i++)
+    {
+        start = rdtsc();
+        write(ping[1], &c, 1);
+        read(pong[0], &c, 1);
+        rtt = rdtsc() - start;
+        total += rtt;
+        if (rtt > worst)
+        {
+            worst = rtt;
+        }
+    }
+    printf(1, "%s: %d hogs, round trip avg %d Kcycles, worst %d Kcycles, %d ticks total\n",
+           name, hogs, (uint)(total >> 10) / PINGPONGS, (uint)(worst >> 10), uptime() - t0);
+
+    wait();
+    for (i = 0; i < hogs; i++)
+    {
+        kill(hog[i]);
+        wait();
+    }
+    close(ping[0]);
+    close(ping[1]);
+    close(pong[0]);
+    close(pong[1]);
+}
+
+// Print how often and how long ptable.lock was held between two snapshots.
+void print_lock(char *name, struct schedstat *before, struct schedstat *after)
+{
+    uint acquires;
+    uint64 cycles;
+
+    acquires = after->lockacquires - before->lockacquires;
+    cycles = after->lockcycles - before->lockcycles;
+    printf(1, "%s: ptable.lock acquired %d times, held %d Kcycles in total, %d cycles/acquire\n",
+           name, acquires, (uint)(cycles >> 10), per_event(cycles, acquires));
+}
+
+void bench_lock(void)
+{
+    struct schedstat before, after;
+    char *argv[] = { "stressfs", 0 };
+    int pid;
+
+    get_sched_stats(&before);
+    run_pingpong("ping-pong", 0);
+    get_sched_stats(&after);
+    print_lock("ping-pong", &before, &after);
+
+    get_sched_stats(&before);
+    pid = fork();
+    if (pid < 0)
+    {
+        printf(1, "fork() failed\n");
+        exit();
+    }
+    if (pid == 0)
+    {
+        exec(argv[0], argv);
+        exit();
+    }
+    wait();
+    get_sched_stats(&after);
+    print_lock("stressfs", &before, &after);
+}
+
+void bench_latency(int hogs)
+{
+    static int nhogs[] = { 0, 2, 8 };
+    static char *names[] = { "round robin", "stride", "lottery", "mlfq" };
+    int policy, i;
+
+    for (policy = SCHEDULER_DEFAULT; policy <= SCHEDULER_MLFQ; policy++)
+    {
+        set_sched(policy);
+        if (hogs >= 0)
+        {
+            run_pingpong(names[policy], hogs);
+            continue;
+        }
+        for (i = 0; i < sizeof(nhogs) / sizeof(nhogs[0]); i++)
+        {
+            run_pingpong(names[policy], nhogs[i]);
+        }
+    }
+    set_sched(SCHEDULER_DEFAULT);
+}
+
+void bench_fork(int hogs)
+{
+    static char *names[] = { "parent-first", "child-first", "alternate" };
+    int hog[NPROC];
+    int policy, i, pid, t0;
+    uint64 start, total, worst, rt;
+
+    for (i = 0; i < hogs; i++)
+    {
+        hog[i] = fork();
+        if (hog[i] < 0)
+        {
+            printf(1, "fork() failed\n");
+            exit();
+        }
+        if (hog[i] == 0)
+        {
+            for (;;)
+                ;
+        }
+    }
+
+    for (policy = FORK_PARENT_FIRST; policy <= FORK_ALTERNATE; policy++)
+    {
+        set_fork_policy(policy);
+        total = 0;
+        worst = 0;
+        t0 = uptime();
+        for (i = 0; i < FORKS; i++)
+        {
+            start = rdtsc();
+            pid = fork();
+            if (pid < 0)
+            {
+                printf(1, "fork() failed\n");
+                exit();
+            }
+            if (pid == 0)
+            {
+                exit();
+            }
+            wait();
+            rt = rdtsc() - start;
+            total += rt;
+            if (rt > worst)
+            {
+                worst = rt;
+            }
+        }
+        printf(1, "%s: %d hogs, fork+wait avg %d Kcycles, worst %d Kcycles, %d ticks total\n",
+               names[policy], hogs, (uint)(total >> 10) / FORKS, (uint)(worst >> 10), uptime() - t0);
+    }
+    set_fork_policy(FORK_PARENT_FIRST);
+
+    for (i = 0; i < hogs; i++)
+    {
+        kill(hog[i]);
+        wait();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || strcmp(argv[1], "switch") == 0)
+    {
+        bench_switch();
+    }
+    else if (strcmp(argv[1], "scale") == 0)
+    {
+        bench_scale();
+    }
+    else if (strcmp(argv[1], "idle") == 0)
+    {
+        bench_idle();
+    }
+    else if (strcmp(argv[1], "slice") == 0)
+    {
+        bench_slice(argc >= 3 ? atoi(argv[2]) : 10);
+    }
+    else if (strcmp(argv[1], "affinity") == 0)
+    {
+        bench_affinity();
+    }
+    else if (strcmp(argv[1], "lock") == 0)
+    {
+        bench_lock();
+    }
+    else if (strcmp(argv[1], "latency") == 0)
+    {
+        bench_latency(argc >= 3 ? atoi(argv[2]) : -1);
+    }
+    else if (strcmp(argv[1], "fork") == 0)
+    {
+        bench_fork(argc >= 3 ? atoi(argv[2]) : 4);
+    }
+    else
+    {
+        printf(1, "Usage: %s [switch|scale|idle|slice [ticks]|latency [hogs]|lock|affinity|fork [hogs]]\n", argv[0]);
+    }
+
+    exit();
+}
@@ -0,0 +1,18 @@
+// Scheduler statistics copied out by get_sched_stats().
+// Cycle counts are rdtsc() deltas.
+
+struct cpustat {
+  uint picks;          // Processes dispatched by this CPU
+  uint steals;         // ...of which were taken from another CPU's run queue
+  uint idles;          // Times this CPU found nothing to run and halted
+  uint64 pickcycles;   // Cycles spent picking a process and switching to it
+  uint64 ticklesscycles; // Cycles spent idle with the timer stopped
+  uint skipped;        // Ticks CPU 0 counted after the fact (see trap.c)
+};
+
+struct schedstat {
+  int ncpu;                  // Number of CPUs in cpu[]
+  uint lockacquires;         // ptable.lock acquisitions
+  uint64 lockcycles;         // Cycles ptable.lock has been held in total
+  struct cpustat cpu[NCPU];
+};
@@ -0,0 +1,210 @@
+#include "types.h"
+#include "param.h"
+#include "trace.h"
+#include "user.h"
+
+// Render the scheduler trace.
+//
+//   schedtrace [-s] [command [args...]]
+//
+// Traces the command from start to exit, or, with no command, drains
+// whatever the kernel has buffered since tracing was last enabled (e.g.
+// after schdtest). Prints the timeline of context switches in time order
+// across CPUs, then each pid's share of the CPU time. -s prints the
+// shares only.
+
+#define MAXPIDS 64
+
+static struct schedevent ev[NCPU * TRACE_RING];
+
+struct share {
+    int pid;
+    int dispatches;
+    uint64 cycles;
+};
+
+static struct share shares[MAXPIDS];
+static int nshares;
+
+// Print a per-mille value as a percentage with one decimal place.
+void print_permille(int permille)
+{
+    printf(1, "%d.%d%%", permille / 10, permille % 10);
+}
+
+struct share *share_of(int pid)
+{
+    int i;
+
+    for (i = 0; i < nshares; i++)
+    {
+        if (shares[i].pid == pid)
+        {
+            return &shares[i];
+        }
+    }
+    if (nshares == MAXPIDS)
+    {
+        return 0;
+    }
+    shares[nshares].pid = pid;
+    return &shares[nshares++];
+}
+
+// The kernel returns each CPU's events together and in order; merge
+// them by timestamp and print one line per switch.
+void print_timeline(int n)
+{
+    int start[NCPU + 1], cur[NCPU];
+    int nseg, i, s, best;
+    uint64 t0;
+
+    nseg = 0;
+    for (i = 0; i < n; i++)
+    {
+        if (i == 0 || ev[i].cpu != ev[i - 1].cpu)
+        {
+            start[nseg++] = i;
+        }
+    }
+    start[nseg] = n;
+    t0 = ev[0].tsc;
+    for (s = 0; s < nseg; s++)
+    {
+        cur[s] = start[s];
+        if (ev[cur[s]].tsc < t0)
+        {
+            t0 = ev[cur[s]].tsc;
+        }
+    }
+
+    printf(1, "  Kcycles  cpu  prev -> next  pass  tickets\n");
+    for (;;)
+    {
+        best = -1;
+        for (s = 0; s < nseg; s++)
+        {
+            if (cur[s] < start[s + 1] && (best < 0 || ev[cur[s]].tsc < ev[cur[best]].tsc))
+            {
+                best = s;
+            }
+        }
+        if (best < 0)
+        {
+            break;
+        }
+        i = cur[best]++;
+        if (ev[i].next == 0)
+        {
+            printf(1, "%d  cpu%d  %d -> idle\n", (uint)((ev[i].tsc - t0) >> 10), ev[i].cpu, ev[i].prev);
+        }
+        else
+        {
+            printf(1, "%d  cpu%d  %d -> %d  %d  %d\n", (uint)((ev[i].tsc - t0) >> 10), ev[i].cpu,
+                   ev[i].prev, ev[i].next, (uint)ev[i].pass, ev[i].tickets);
+        }
+    }
+}
+
+// Charge the time between a CPU's consecutive events to the pid it
+// switched to; the last event of each CPU has no end and is not charged.
+void print_shares(int n)
+{
+    struct share *sh;
+    uint64 total, cycles;
+    int i, shift;
+
+    total = 0;
+    for (i = 0; i < n; i++)
+    {
+        if ((sh = share_of(ev[i].next)) == 0)
+        {
+            continue;
+        }
+        sh->dispatches++;
+        if (i + 1 < n && ev[i + 1].cpu == ev[i].cpu)
+        {
+            sh->cycles += ev[i + 1].tsc - ev[i].tsc;
+            total += ev[i + 1].tsc - ev[i].tsc;
+        }
+    }
+
+    // Scale the cycle counts down so that the per-mille math fits in 32 bits.
+    shift = 0;
+    while ((total >> shift) > 1000000)
+    {
+        shift++;
+    }
+    if ((total >> shift) == 0)
+    {
+        printf(1, "no CPU time recorded\n");
+        return;
+    }
+
+    for (i = 0; i < nshares; i++)
+    {
+        cycles = shares[i].cycles >> shift;
+        if (shares[i].pid == 0)
+        {
+            printf(1, "idle: ");
+        }
+        else
+        {
+            printf(1, "pid %d: ", shares[i].pid);
+        }
+        print_permille((uint)cycles * 1000 / (uint)(total >> shift));
+        printf(1, " of CPU time, %d dispatches\n", shares[i].dispatches);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int summary, n, pid;
+    uint dropped;
+
+    summary = 0;
+    argv++;
+    argc--;
+    if (argc > 0 && strcmp(argv[0], "-s") == 0)
+    {
+        summary = 1;
+        argv++;
+        argc--;
+    }
+
+    if (argc > 0)
+    {
+        enable_sched_trace(1);
+        pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork() failed\n");
+            exit();
+        }
+        if (pid == 0)
+        {
+            exec(argv[0], argv);
+            printf(1, "exec %s failed\n", argv[0]);
+            exit();
+        }
+        wait();
+        enable_sched_trace(0);
+    }
+
+    dropped = 0;
+    n = sched_trace_read(ev, NCPU * TRACE_RING, &dropped);
+    if (n <= 0)
+    {
+        printf(1, "no trace events\n");
+        exit();
+    }
+
+    if (!summary)
+    {
+        print_timeline(n);
+    }
+    print_shares(n);
+    printf(1, "%d events, %d dropped\n", n, dropped);
+
+    exit();
+}
@@ -1,6 +1,7 @@
 // Shell.
 
 #include "types.h"
+#include "param.h"
 #include "user.h"
 #include "fcntl.h"
 
@@ -156,6 +157,10 @@ main(void)
     }
   }
 
+  // Each command is forked and exec'd while the shell waits, so let
+  // the child run first.
+  set_fork_policy(FORK_CHILD_FIRST);
+
   // Read and run input commands.
   while(getcmd(buf, sizeof(buf)) >= 0){
     if(buf[0] == 'c' && buf[1] == 'd' && buf[2] == ' '){
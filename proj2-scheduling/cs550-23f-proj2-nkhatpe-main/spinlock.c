@@ -15,6 +15,7 @@ initlock(struct spinlock *lk, char *name)
   lk->name = name;
   lk->locked = 0;
   lk->cpu = 0;
+  lk->stat = 0;
 }
 
 // Acquire the lock.
@@ -40,6 +41,10 @@ acquire(struct spinlock *lk)
   // Record info about lock acquisition for debugging.
   lk->cpu = mycpu();
   getcallerpcs(&lk, lk->pcs);
+  if(lk->stat){
+    lk->stat->nacquire++;
+    lk->stat->acquired = rdtsc();
+  }
 }
 
 // Release the lock.
@@ -49,6 +54,8 @@ release(struct spinlock *lk)
   if(!holding(lk))
     panic("release");
 
+  if(lk->stat)
+    lk->stat->holdcycles += rdtsc() - lk->stat->acquired;
   lk->pcs[0] = 0;
   lk->cpu = 0;
 
@@ -7,5 +7,15 @@ struct spinlock {
   struct cpu *cpu;   // The cpu holding the lock.
   uint pcs[10];      // The call stack (an array of program counters)
                      // that locked the lock.
+
+  // For lock statistics:
+  struct lockstat *stat; // Where to count, or 0 to not bother.
+};
+
+// Hold-time statistics of a lock whose stat points here.
+struct lockstat {
+  uint64 acquired;   // rdtsc() when the lock was last acquired.
+  uint64 holdcycles; // Total cycles the lock has been held.
+  uint nacquire;     // Number of times the lock has been acquired.
 };
 
@@ -109,6 +109,16 @@ extern int sys_fork_alternate_winner(void);
 extern int sys_set_sched(void);
 extern int sys_tickets_owned(void);
 extern int sys_transfer_tickets(void);
+extern int sys_yield(void);
+extern int sys_get_sched_stats(void);
+extern int sys_sched_trace_read(void);
+extern int sys_getprocstats(void);
+extern int sys_set_mlfq_boost(void);
+extern int sys_set_quantum(void);
+extern int sys_setaffinity(void);
+extern int sys_fund_children(void);
+extern int sys_set_rt(void);
+extern int sys_set_fork_policy(void);
 
 static int (*syscalls[])(void) = {
 [SYS_fork]    sys_fork,
@@ -138,6 +148,16 @@ static int (*syscalls[])(void) = {
 [SYS_set_sched] sys_set_sched,
 [SYS_tickets_owned] sys_tickets_owned,
 [SYS_transfer_tickets] sys_transfer_tickets,
+[SYS_yield] sys_yield,
+[SYS_get_sched_stats] sys_get_sched_stats,
+[SYS_sched_trace_read] sys_sched_trace_read,
+[SYS_getprocstats] sys_getprocstats,
+[SYS_set_mlfq_boost] sys_set_mlfq_boost,
+[SYS_set_quantum] sys_set_quantum,
+[SYS_setaffinity] sys_setaffinity,
+[SYS_fund_children] sys_fund_children,
+[SYS_set_rt] sys_set_rt,
+[SYS_set_fork_policy] sys_set_fork_policy,
 };
 
 void
@@ -25,4 +25,14 @@
 #define SYS_fork_alternate_winner 24
 #define SYS_set_sched 25
 #define SYS_tickets_owned 26
-#define SYS_transfer_tickets 27
\ No newline at end of file
+#define SYS_transfer_tickets 27
+#define SYS_yield 28
+#define SYS_get_sched_stats 29
+#define SYS_sched_trace_read 30
+#define SYS_getprocstats 31
+#define SYS_set_mlfq_boost 32
+#define SYS_set_quantum 33
+#define SYS_setaffinity 34
+#define SYS_fund_children 35
+#define SYS_set_rt 36
+#define SYS_set_fork_policy 37
\ No newline at end of file
@@ -6,7 +6,9 @@
 #include "memlayout.h"
 #include "mmu.h"
 #include "proc.h"
-#include "stdio.h"
+#include "schedstat.h"
+#include "trace.h"
+#include "pstat.h"
 
 int
 sys_fork(void)
@@ -37,6 +39,13 @@ sys_kill(void)
   return kill(pid);
 }
 
+int
+sys_yield(void)
+{
+  yield();
+  return 0;
+}
+
 int
 sys_getpid(void)
 {
@@ -100,23 +109,46 @@ int sys_shutdown(void)
   return 0;
 }
 
-extern int sched_trace_enabled;
-extern int sched_trace_counter;
 int sys_enable_sched_trace(void)
 {
-  if (argint(0, &sched_trace_enabled) < 0)
+  int enable;
+
+  if (argint(0, &enable) < 0)
   {
     cprintf("enable_sched_trace() failed!\n");
+    return 0;
   }
-  
-  sched_trace_counter = 0;
+
+  traceenable(enable);
 
   return 0;
 }
 
-extern int winner;
+// Function to drain buffered scheduler trace events into a user buffer.
+int sys_sched_trace_read(void)
+{
+	struct schedevent *buf;
+	int n;
+	uint *dropped;
+
+	// Get the buffer, its capacity in events and the dropped-event counter.
+	if (argint(1, &n) < 0 || n < 0)
+	{
+		return -1;
+	}
+	if (n > NCPU * TRACE_RING)
+	{
+		n = NCPU * TRACE_RING; // No more than the rings can hold, so the size cannot overflow.
+	}
+	if (argptr(0, (void*)&buf, n * sizeof(*buf)) < 0 || argptr(2, (void*)&dropped, sizeof(*dropped)) < 0)
+	{
+		return -1; // Return an error if either pointer is not valid user memory.
+	}
+
+	return traceread(buf, n, dropped);
+}
 
-// Function to set the winner variable, affecting scheduling behavior.
+// Function to make the current process alternate between parent-first and child-first forks.
 int sys_fork_alternate_winner(void)
 {
 	int n;
@@ -127,21 +159,19 @@ int sys_fork_alternate_winner(void)
 		return -1; // Return an error if the argument retrieval fails.
 	}
 
-	// Set the winner variable based on the value of 'n'.
+	// Set the fork policy of the current process based on the value of 'n'.
 	if (n == 1)
 	{
-		winner = 1; // Set the winner to 1, altering the fork behavior.
+		procs_set_fork_policy(FORK_ALTERNATE, myproc()); // Child-first on every other fork.
 	}
 	if (n == 0)
 	{
-		winner = 0; // Set the winner to 0,
+		procs_set_fork_policy(FORK_PARENT_FIRST, myproc()); // Back to the default.
 	}
 
 	return 0; // Return 0 to indicate success.
 }
 
-extern int sched_policy;
-
 // Function to set the scheduling policy (0 for Round Robin, 1 for Stride Scheduling).
 int sys_set_sched(void)
 {
@@ -156,11 +186,19 @@ int sys_set_sched(void)
 	// Set the scheduling policy based on the value of 'x'.
 	if (x == 1)
 	{
-		sched_policy = 1; // Set the policy to Stride Scheduling.
+		sched_set_policy(1); // Set the policy to Stride Scheduling.
 	}
 	if (x == 0)
 	{
-		sched_policy = 0; // Set the policy to Round Robin.
+		sched_set_policy(0); // Set the policy to Round Robin.
+	}
+	if (x == 2)
+	{
+		sched_set_policy(2); // Set the policy to Lottery Scheduling.
+	}
+	if (x == 3)
+	{
+		sched_set_policy(3); // Set the policy to the Multi-Level Feedback Queue.
 	}
 
 	return 0; // Return 0 to indicate success.
@@ -198,15 +236,135 @@ int sys_transfer_tickets(void)
 		return -1; // Return an error if the number of tickets to transfer is negative.
 	}
 
-	// Check if the number of tickets to transfer is greater than the current process's tickets minus 1.
-	if (tickets > (myproc()->tickets - 1))
+	// Call a function to perform the ticket transfer and return the resulting number of tickets
+	// (-2 if the current process cannot spare them, -3 if there is no such process to receive them).
+	tickets_after_transfer = tickets_transfer(pid, tickets, myproc());
+
+	return tickets_after_transfer; // Return the number of tickets after the transfer.
+}
+
+
+// Function to copy a snapshot of the scheduler statistics to user space.
+int sys_get_sched_stats(void)
+{
+	struct schedstat *st;
+
+	// Get the user buffer argument from the system call.
+	if (argptr(0, (void*)&st, sizeof(*st)) < 0)
 	{
-		return -2; // Return an error if the transfer is not allowed.
+		return -1; // Return an error if the buffer is not valid user memory.
 	}
 
-	// Call a function to perform the ticket transfer and return the resulting number of tickets.
-	tickets_after_transfer = tickets_transfer(pid, tickets, myproc());
+	sched_get_stats(st);
 
-	return tickets_after_transfer; // Return the number of tickets after the transfer.
+	return 0;
+}
+
+// Function to copy the scheduler accounting of the process with 'pid' (or of all processes if 'pid' <= 0) to user space.
+int sys_getprocstats(void)
+{
+	int pid;
+	struct pstat *ps;
+
+	// Get the 'pid' and buffer arguments from the system call.
+	if (argint(0, &pid) < 0 || argptr(1, (void*)&ps, sizeof(*ps)) < 0)
+	{
+		return -1; // Return an error if the argument retrieval fails.
+	}
+
+	if (procs_stats(pid, ps) == 0 && pid > 0)
+	{
+		return -1; // Return an error if no process with 'pid' exists.
+	}
+
+	return ps->nproc;
+}
+
+// Function to set the number of ticks between MLFQ priority boosts.
+int sys_set_mlfq_boost(void)
+{
+	int ticks;
+
+	// Get the 'ticks' argument from the system call.
+	if (argint(0, &ticks) < 0 || ticks <= 0)
+	{
+		return -1; // Return an error if the interval is missing or not positive.
+	}
+
+	return mlfq_set_boost(ticks); // Return the previous interval.
+}
+
+// Function to set the quantum in ticks of the round robin (0), stride (1) or lottery (2) policy.
+int sys_set_quantum(void)
+{
+	int policy, ticks;
+
+	// Get the 'policy' and 'ticks' arguments from the system call.
+	if (argint(0, &policy) < 0 || argint(1, &ticks) < 0)
+	{
+		return -1; // Return an error if the argument retrieval fails.
+	}
+
+	if (policy < 0 || policy > 2 || ticks <= 0)
+	{
+		return -1; // MLFQ has per-level quanta; other values are invalid.
+	}
+
+	return sched_set_quantum(policy, ticks); // Return the previous quantum.
+}
+
+// Function to set the CPUs (bit i for CPU i) that the process with 'pid' may run on.
+int sys_setaffinity(void)
+{
+	int pid, mask;
+
+	// Get the 'pid' and 'mask' arguments from the system call.
+	if (argint(0, &pid) < 0 || argint(1, &mask) < 0)
+	{
+		return -1; // Return an error if the argument retrieval fails.
+	}
+
+	return procs_set_affinity(pid, (uint)mask); // -1 if there is no such process or no such CPU.
 }
 
+// Function to put a number of the current process's tickets behind a currency that funds its children.
+int sys_fund_children(void)
+{
+	int tickets;
+
+	// Get the 'tickets' argument from the system call.
+	if (argint(0, &tickets) < 0)
+	{
+		return -1; // Return an error if the argument retrieval fails.
+	}
+
+	return procs_fund_children(tickets, myproc()); // Return the tickets the current process keeps.
+}
+
+// Function to make the process with 'pid' real-time with a period and a budget in ticks.
+int sys_set_rt(void)
+{
+	int pid, period, budget;
+
+	// Get the 'pid', 'period' and 'budget' arguments from the system call.
+	if (argint(0, &pid) < 0 || argint(1, &period) < 0 || argint(2, &budget) < 0)
+	{
+		return -1; // Return an error if the argument retrieval fails.
+	}
+
+	return procs_set_rt(pid, period, budget); // -1 if the process is not found or not admitted.
+}
+
+// Function to set the fork policy of the current process and its future children.
+int sys_set_fork_policy(void)
+{
+	int policy;
+
+	// Get the 'policy' argument from the system call.
+	if (argint(0, &policy) < 0)
+	{
+		return -1; // Return an error if the argument retrieval fails.
+	}
+
+	return procs_set_fork_policy(policy, myproc()); // The previous policy, or -1 if invalid.
+}
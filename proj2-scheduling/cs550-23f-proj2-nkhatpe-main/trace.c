@@ -0,0 +1,125 @@
+// Scheduler trace.
+//
+// Each CPU records its context switches in its own ring of
+// binary events.  Only that CPU writes its ring, with interrupts
+// off in scheduler(), so recording takes no locks and does no I/O:
+// it fills the slot at head and then publishes it by advancing
+// head.  A full ring drops the event and counts it rather than
+// overwrite slots a reader may be copying.
+//
+// sched_trace_read() drains the rings in bulk.  Readers serialize
+// on tracelock among themselves; it is never taken by a CPU
+// recording an event.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "x86.h"
+#include "proc.h"
+#include "spinlock.h"
+#include "trace.h"
+
+struct tracering {
+  struct schedevent ev[TRACE_RING];
+  uint head;       // next slot to write; advanced only by the owning CPU
+  uint tail;       // next slot to drain; advanced only by a reader
+  uint dropped;    // events lost because the ring was full; only ever grows
+  uint seen;       // dropped as of the last read; used only by a reader
+  int lastpid;     // pid the owning CPU last dispatched, 0 if idle
+};
+
+static struct tracering rings[NCPU];
+static struct spinlock tracelock;
+int sched_trace_enabled = 0; // ZYF: for OS CPU/process project
+
+void
+traceinit(void)
+{
+  initlock(&tracelock, "schedtrace");
+}
+
+// Record that CPU c switched to p, or went idle if p is 0.
+// Called by the scheduler with interrupts off.
+void
+tracesched(struct cpu *c, struct proc *p)
+{
+  struct tracering *r;
+  struct schedevent *e;
+  int next;
+
+  if(!sched_trace_enabled)
+    return;
+  r = &rings[c - cpus];
+  next = p ? p->pid : 0;
+  if(next == 0 && r->lastpid == 0)
+    return;  // still idle
+  if(r->head - r->tail >= TRACE_RING){
+    r->dropped++;
+    return;
+  }
+
+  e = &r->ev[r->head % TRACE_RING];
+  e->tsc = rdtsc();
+  e->pass = p ? p->pass : 0;
+  e->cpu = c - cpus;
+  e->prev = r->lastpid;
+  e->next = next;
+  e->tickets = p ? p->tickets : 0;
+  r->lastpid = next;
+
+  // Make the event visible before the slot is published.
+  __sync_synchronize();
+  r->head++;
+}
+
+// Turn recording on or off. Turning it on discards
+// whatever the rings still hold.
+void
+traceenable(int enable)
+{
+  int i;
+
+  if(enable){
+    acquire(&tracelock);
+    for(i = 0; i < NCPU; i++){
+      rings[i].tail = rings[i].head;
+      rings[i].seen = rings[i].dropped;
+    }
+    release(&tracelock);
+  }
+  sched_trace_enabled = enable;
+}
+
+// Move up to n events into buf, one CPU's events after
+// another, each CPU's in the order they happened.
+// Adds the number of dropped events to *dropped.
+// Returns the number of events copied.
+int
+traceread(struct schedevent *buf, int n, uint *dropped)
+{
+  struct tracering *r;
+  uint head, tail, d;
+  int i, k;
+
+  k = 0;
+  acquire(&tracelock);
+  for(i = 0; i < ncpu; i++){
+    r = &rings[i];
+    head = r->head;
+    // Read the events only after seeing head.
+    __sync_synchronize();
+    for(tail = r->tail; tail != head && k < n; tail++)
+      buf[k++] = r->ev[tail % TRACE_RING];
+    // Finish copying before handing the slots back to the writer.
+    __sync_synchronize();
+    r->tail = tail;
+    // The writer counts drops without a lock, so never reset the count.
+    d = r->dropped;
+    *dropped += d - r->seen;
+    r->seen = d;
+  }
+  release(&tracelock);
+  return k;
+}
@@ -0,0 +1,12 @@
+// Scheduler trace events, drained by sched_trace_read().
+
+#define TRACE_RING 4096   // events buffered per CPU (a power of two)
+
+struct schedevent {
+  uint64 tsc;      // rdtsc() when the CPU switched
+  uint64 pass;     // next's pass when it was dispatched (stride)
+  int cpu;         // CPU that switched
+  int prev;        // pid that ran before on this CPU, 0 if it was idle
+  int next;        // pid dispatched, 0 if the CPU went idle
+  int tickets;     // next's tickets
+};
@@ -13,6 +13,7 @@ struct gatedesc idt[256];
 extern uint vectors[];  // in vectors.S: array of 256 entry pointers
 struct spinlock tickslock;
 uint ticks;
+uint64 tsc_per_tick;    // TSC cycles per tick, measured on CPU 0 at boot
 
 void
 tvinit(void)
@@ -32,6 +33,49 @@ idtinit(void)
   lidt(idt, sizeof(idt));
 }
 
+// Measure the length of a tick in TSC cycles, once the timer is steady.
+static void
+calibrate(void)
+{
+  static uint64 last;
+  uint64 now;
+
+  if(tsc_per_tick != 0 || ticks < 10)
+    return;
+  now = rdtsc();
+  if(last != 0)
+    tsc_per_tick = now - last;
+  last = now;
+}
+
+// CPU c stopped its timer while idle and has taken an interrupt:
+// restart the timer and, on CPU 0, count the ticks it skipped.
+static void
+tickresume(struct cpu *c)
+{
+  uint64 idle;
+  uint n;
+
+  c->tickless = 0;
+  lapicstarttimer();
+  idle = rdtsc() - c->idlestart;
+  c->ticklesscycles += idle;
+  if(c != &cpus[0] || tsc_per_tick == 0)
+    return;
+
+  // Subtract rather than divide: there is no 64-bit division in
+  // the kernel, and the loop runs once per skipped tick.
+  for(n = 0; idle >= tsc_per_tick; n++)
+    idle -= tsc_per_tick;
+  c->skipped += n;
+  if(n > 0){
+    acquire(&tickslock);
+    ticks += n;
+    wakeup(&ticks);
+    release(&tickslock);
+  }
+}
+
 //PAGEBREAK: 41
 void
 trap(struct trapframe *tf)
@@ -46,14 +90,23 @@ trap(struct trapframe *tf)
     return;
   }
 
+  if(tf->trapno >= T_IRQ0 && mycpu()->tickless)
+    tickresume(mycpu());
+
   switch(tf->trapno){
   case T_IRQ0 + IRQ_TIMER:
     if(cpuid() == 0){
       acquire(&tickslock);
       ticks++;
+      calibrate();
       wakeup(&ticks);
       release(&tickslock);
     }
+    rttick();
+    lapiceoi();
+    break;
+  case T_IRQ0 + IRQ_WAKE:
+    // Only needed to bring a tickless CPU out of hlt.
     lapiceoi();
     break;
   case T_IRQ0 + IRQ_IDE:
@@ -103,8 +156,13 @@ trap(struct trapframe *tf)
   // Force process to give up CPU on clock tick.
   // If interrupts were on while locks held, would need to check nlock.
   if(myproc() && myproc()->state == RUNNING &&
-     tf->trapno == T_IRQ0+IRQ_TIMER)
-    yield();
+     tf->trapno == T_IRQ0+IRQ_TIMER){
+    myproc()->runticks++;
+    if(schedtick(myproc())){
+      myproc()->npreempt++;
+      yield();
+    }
+  }
 
   // Check if the process has been killed since we yielded
   if(myproc() && myproc()->killed && (tf->cs&3) == DPL_USER)
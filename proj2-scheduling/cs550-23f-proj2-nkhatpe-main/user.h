@@ -1,5 +1,8 @@
 struct stat;
 struct rtcdate;
+struct schedstat;
+struct schedevent;
+struct pstat;
 
 // system calls
 int fork(void);
@@ -29,6 +32,16 @@ void fork_alternate_winner(int enable);
 void set_sched(int);
 int tickets_owned(int pid);
 int transfer_tickets(int pid, int tickets);
+int yield(void);
+int get_sched_stats(struct schedstat*);
+int sched_trace_read(struct schedevent*, int, uint*);
+int getprocstats(int, struct pstat*);
+int set_mlfq_boost(int);
+int set_quantum(int, int);
+int setaffinity(int, int);
+int fund_children(int);
+int set_rt(int, int, int);
+int set_fork_policy(int);
 
 
 // ulib.c
@@ -1,10 +1,12 @@
 struct buf;
 struct context;
+struct dmsmp;
 struct file;
 struct inode;
 struct pipe;
 struct proc;
 struct rtcdate;
+struct shm;
 struct spinlock;
 struct sleeplock;
 struct stat;
@@ -40,6 +42,8 @@ int             dirlink(struct inode*, char*, uint);
 struct inode*   dirlookup(struct inode*, char*, uint*);
 struct inode*   ialloc(uint, short);
 struct inode*   idup(struct inode*);
+struct inode*   iexec(struct inode*);
+void            iunexec(struct inode*);
 void            iinit(int dev);
 void            ilock(struct inode*);
 void            iput(struct inode*);
@@ -66,6 +70,8 @@ void            ioapicinit(void);
 // kalloc.c
 char*           kalloc(void);
 void            kfree(char*);
+int             kref(char*);
+int             krefcnt(char*);
 void            kinit1(void*, void*);
 void            kinit2(void*, void*);
 
@@ -95,6 +101,11 @@ void            mpinit(void);
 void            picenable(int);
 void            picinit(void);
 
+// pcache.c
+void            pcacheinit(void);
+char*           pcget(struct inode*, uint);
+void            pcinval(struct inode*);
+
 // pipe.c
 int             pipealloc(struct file**, struct file**);
 void            pipeclose(struct pipe*, int);
@@ -104,12 +115,15 @@ int             pipewrite(struct pipe*, char*, int);
 //PAGEBREAK: 16
 // proc.c
 int             cpuid(void);
+struct dmsmp*   dmsmpdup(struct proc*);
+void            dmsmpput(struct dmsmp*);
 void            exit(void);
 int             fork(void);
 int             growproc(int);
 int             kill(int);
 struct cpu*     mycpu(void);
 struct proc*    myproc();
+int             pagefault(uint);
 void            pinit(void);
 void            procdump(void);
 void            scheduler(void) __attribute__((noreturn));
@@ -124,6 +138,16 @@ void            yield(void);
 // swtch.S
 void            swtch(struct context**, struct context*);
 
+// shm.c
+char*           shmattach(int, uint);
+int             shmclose(int);
+int             shmdetach(uint);
+void            shmdrop(struct proc*);
+int             shmfork(struct proc*, struct proc*);
+void            shminit(void);
+int             shmopen(char*, int);
+int             shmoverlap(struct proc*, uint, uint);
+
 // spinlock.c
 void            acquire(struct spinlock*);
 void            getcallerpcs(void*, uint*);
@@ -150,7 +174,7 @@ char*           strncpy(char*, const char*, int);
 
 // syscall.c
 int             argint(int, int*);
-int             argptr(int, char**, int);
+int             argptr(int, char**, int, int);
 int             argstr(int, char**);
 int             fetchint(uint, int*);
 int             fetchstr(uint, char**);
@@ -177,14 +201,18 @@ pde_t*          setupkvm(void);
 char*           uva2ka(pde_t*, char*);
 int             allocuvm(pde_t*, uint, uint);
 int             deallocuvm(pde_t*, uint, uint);
+int             lazyalloc(pde_t*, uint);
+int             pagein(uint, uint, int);
+int             unmapped(pde_t*, uint, uint);
 void            freevm(pde_t*);
 void            inituvm(pde_t*, char*, uint);
-int             loaduvm(pde_t*, char*, struct inode*, uint, uint);
 pde_t*          copyuvm(pde_t*, uint);
+int             cowpage(pde_t*, uint);
 void            switchuvm(struct proc*);
 void            switchkvm(void);
 int             copyout(pde_t*, uint, void*, uint);
 void            clearpteu(pde_t *pgdir, char *uva);
+void            setpteshr(pde_t *pgdir, char *uva);
 // Map virtual address range [va, va+size) to the physical address range [pa, pa+size)
 // in the given page directory pgdir with the specified permissions perm
 // This function is used to establish a mapping between virtual and physical memory
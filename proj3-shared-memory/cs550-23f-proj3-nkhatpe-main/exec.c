@@ -10,11 +10,12 @@
 int
 exec(char *path, char **argv)
 {
-  char *s, *last;
-  int i, off;
+  char *s, *last, *static_page, *dynamic_page;
+  int i, off, nseg;
   uint argc, sz, sp, ustack[3+MAXARG+1];
   struct elfhdr elf;
-  struct inode *ip;
+  struct inode *ip, *exe, *oldexe;
+  struct execseg seg[NEXECSEG];
   struct proghdr ph;
   pde_t *pgdir, *oldpgdir;
   struct proc *curproc = myproc();
@@ -28,6 +29,7 @@ exec(char *path, char **argv)
   }
   ilock(ip);
   pgdir = 0;
+  exe = 0;
 
   // Check ELF header
   if(readi(ip, (char*)&elf, 0, sizeof(elf)) != sizeof(elf))
@@ -38,8 +40,11 @@ exec(char *path, char **argv)
   if((pgdir = setupkvm()) == 0)
     goto bad;
 
-  // Load program into memory.
+  // Record where the program goes; pagefault() reads each page
+  // from ip on first touch.
   sz = 0;
+  nseg = 0;
+  memset(seg, 0, sizeof(seg));
   for(i=0, off=elf.phoff; i<elf.phnum; i++, off+=sizeof(ph)){
     if(readi(ip, (char*)&ph, off, sizeof(ph)) != sizeof(ph))
       goto bad;
@@ -47,15 +52,19 @@ exec(char *path, char **argv)
       continue;
     if(ph.memsz < ph.filesz)
       goto bad;
-    if(ph.vaddr + ph.memsz < ph.vaddr)
+    if(ph.vaddr + ph.memsz < ph.vaddr || ph.vaddr + ph.memsz > USERTOP)
       goto bad;
-    if((sz = allocuvm(pgdir, sz, ph.vaddr + ph.memsz)) == 0)
-      goto bad;
-    if(ph.vaddr % PGSIZE != 0)
-      goto bad;
-    if(loaduvm(pgdir, (char*)ph.vaddr, ip, ph.off, ph.filesz) < 0)
+    if(ph.vaddr % PGSIZE != 0 || nseg == NEXECSEG)
       goto bad;
+    seg[nseg].va = ph.vaddr;
+    seg[nseg].memsz = ph.memsz;
+    seg[nseg].off = ph.off;
+    seg[nseg].filesz = ph.filesz;
+    nseg++;
+    if(ph.vaddr + ph.memsz > sz)
+      sz = ph.vaddr + ph.memsz;
   }
+  exe = iexec(ip);
   iunlockput(ip);
   end_op();
   ip = 0;
@@ -68,7 +77,7 @@ exec(char *path, char **argv)
   clearpteu(pgdir, (char*)(sz - 2*PGSIZE));
   
 // Allocate a static page for the current process
-curproc->static_page = (char *)sz;
+static_page = (char *)sz;
 
 // Attempt to allocate a virtual memory block for the process
 if ((sz = allocuvm(pgdir, sz, sz + PGSIZE)) == 0) {
@@ -76,14 +85,12 @@ if ((sz = allocuvm(pgdir, sz, sz + PGSIZE)) == 0) {
     goto bad;
 }
 
-// Assign the allocated virtual memory block to the dynamic page of the process
-curproc->dynamic_page = (char *)(sz);
+// Keep the static page shared with children instead of copy-on-write
+setpteshr(pgdir, (char *)(sz - PGSIZE));
 
-// Attempt to allocate another virtual memory block for the process
-if ((sz = allocuvm(pgdir, sz, sz + PGSIZE)) == 0) {
-    // Handle allocation failure
-    goto bad;
-}
+// Reserve the dynamic page; dmsmpfault() allocates it on first touch
+dynamic_page = (char *)(sz);
+sz += PGSIZE;
 
 // Calculate the stack pointer for the process
 sp = sz - 2 * PGSIZE;
@@ -118,10 +125,26 @@ sp = sz - 2 * PGSIZE;
   oldpgdir = curproc->pgdir;
   curproc->pgdir = pgdir;
   curproc->sz = sz;
+  curproc->io_ring = 0;  // went with the old address space
+  curproc->static_page = static_page;
+  curproc->dynamic_page = dynamic_page;
+  dmsmpput(curproc->dmsmp);
+  curproc->dmsmp = 0;
+  shmdrop(curproc);
+  oldexe = curproc->exe;
+  curproc->exe = exe;
+  for(i = 0; i < NEXECSEG; i++)
+    curproc->seg[i] = seg[i];
+  curproc->lazypg = 0;
   curproc->tf->eip = elf.entry;  // main
   curproc->tf->esp = sp;
   switchuvm(curproc);
   freevm(oldpgdir);
+  if(oldexe){
+    begin_op();
+    iunexec(oldexe);
+    end_op();
+  }
   return 0;
 
  bad:
@@ -131,5 +154,10 @@ sp = sz - 2 * PGSIZE;
     iunlockput(ip);
     end_op();
   }
+  if(exe){
+    begin_op();
+    iunexec(exe);
+    end_op();
+  }
   return -1;
 }
@@ -0,0 +1,103 @@
+/*
+ * Demand-paged exec benchmark: fork()+exec() latency of a program
+ * none of whose pages are in the executable page cache (cold), then of
+ * the same program again (warm), and the frames the cache keeps.
+ *
+ * The cold copy is a fresh file, so no earlier run can have cached it.
+ *
+ *   execbench [program] [rounds]
+ */
+#include "types.h"
+#include "user.h"
+#include "fcntl.h"
+
+#define ROUNDS 20
+
+char *copy = "execbench.tmp";
+char buf[512];
+
+// Copy src to dst; returns -1 on failure.
+int copyfile(char *src, char *dst)
+{
+    int in, out, n;
+
+    if ((in = open(src, O_RDONLY)) < 0)
+        return -1;
+    if ((out = open(dst, O_CREATE | O_WRONLY)) < 0)
+    {
+        close(in);
+        return -1;
+    }
+    while ((n = read(in, buf, sizeof(buf))) > 0)
+        write(out, buf, n);
+    close(in);
+    close(out);
+    return 0;
+}
+
+// Cycles for 'rounds' fork()+exec()+wait() of args[0].
+uint64 run(char **args, int rounds)
+{
+    uint64 start;
+    int i, pid;
+
+    start = rdtsc();
+    for (i = 0; i < rounds; i++)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork() failed!\n");
+            exit();
+        }
+        if (pid == 0)
+        {
+            close(1);   // the program's output is not what is measured
+            exec(args[0], args);
+            exit();
+        }
+        wait();
+    }
+    return rdtsc() - start;
+}
+
+int
+main(int argc, char *argv[])
+{
+    char *args[3];
+    uint64 cold, warm;
+    int rounds, f0, f1;
+
+    // Child of the rounds when execbench measures itself.
+    if (argc >= 2 && strcmp(argv[1], "-x") == 0)
+        exit();
+
+    args[0] = copy;
+    args[1] = argc >= 2 ? 0 : "-x";
+    args[2] = 0;
+    rounds = argc >= 3 ? atoi(argv[2]) : ROUNDS;
+    if (rounds <= 0)
+        rounds = ROUNDS;
+
+    if (copyfile(argc >= 2 ? argv[1] : argv[0], copy) < 0)
+    {
+        printf(1, "cannot copy %s\n", argc >= 2 ? argv[1] : argv[0]);
+        exit();
+    }
+
+    f0 = get_free_frame_cnt();
+    cold = run(args, 1);
+    f1 = get_free_frame_cnt();
+    warm = run(args, rounds);
+
+    printf(1, "cold exec: %d cycles\n", percycles(cold, 1));
+    printf(1, "warm exec: %d cycles/round over %d rounds\n", percycles(warm, rounds), rounds);
+    printf(1, "page cache: %d frames after the cold run, %d after the warm runs\n",
+           f0 - f1, f0 - get_free_frame_cnt());
+
+    // Removing the copy drops its pages from the cache.
+    unlink(copy);
+    printf(1, "after unlink: %d frames\n", f0 - get_free_frame_cnt());
+
+    exit();
+}
@@ -14,8 +14,10 @@ struct inode {
   uint dev;           // Device number
   uint inum;          // Inode number
   int ref;            // Reference count
+  int nexec;          // Processes running it, see iexec()
   struct sleeplock lock; // protects everything below here
   int valid;          // inode has been read from disk?
+  int cached;         // May have pages in the exec page cache (pcache.c)
 
   short type;         // copy of disk inode
   short major;
@@ -0,0 +1,93 @@
+/*
+ * Copy-on-write fork benchmark: the frames a fork() takes from the free
+ * list with a large parent heap, the frames taken by the first writes
+ * after it, and the cost of the fork()+exec() pairs the shell makes.
+ *
+ *   forkbench [heap KB] [rounds]
+ */
+#include "types.h"
+#include "user.h"
+
+#define PGSIZE 4096
+#define HEAP_KB 4096
+#define ROUNDS  20
+
+int
+main(int argc, char *argv[])
+{
+    char *heap, *args[3];
+    uint64 start, cycles;
+    int heapkb, rounds, i, n, before, after, pid;
+
+    // Child of the fork()+exec() rounds: nothing to do.
+    if (argc >= 2 && strcmp(argv[1], "-x") == 0)
+        exit();
+
+    heapkb = argc >= 2 ? atoi(argv[1]) : HEAP_KB;
+    rounds = argc >= 3 ? atoi(argv[2]) : ROUNDS;
+    if (heapkb <= 0)
+        heapkb = HEAP_KB;
+    if (rounds <= 0)
+        rounds = ROUNDS;
+
+    heap = sbrk(heapkb * 1024);
+    if (heap == (char *)-1)
+    {
+        printf(1, "sbrk(%d KB) failed\n", heapkb);
+        exit();
+    }
+    for (i = 0; i < heapkb * 1024; i += PGSIZE)
+        heap[i] = i;
+    printf(1, "parent heap: %d KB (%d pages)\n", heapkb, heapkb * 1024 / PGSIZE);
+
+    before = get_free_frame_cnt();
+    pid = fork();
+    if (pid < 0)
+    {
+        printf(1, "fork() failed!\n");
+        exit();
+    }
+    else if (pid == 0) // child
+    {
+        // Page tables, kernel stack and the stack page this child has written.
+        after = get_free_frame_cnt();
+        printf(1, "Child: fork took %d frames\n", before - after);
+        n = after;
+        for (i = 0; i < 8 * PGSIZE && i < heapkb * 1024; i += PGSIZE)
+            heap[i] = 0;
+        after = get_free_frame_cnt();
+        printf(1, "Child: writing %d heap pages took %d frames\n", i / PGSIZE, n - after);
+        exit();
+    }
+    wait();
+    printf(1, "Parent: %d frames not yet returned after the child exited\n",
+           before - get_free_frame_cnt());
+
+    args[0] = argv[0];
+    args[1] = "-x";
+    args[2] = 0;
+    start = rdtsc();
+    n = uptime();
+    for (i = 0; i < rounds; i++)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork() failed!\n");
+            exit();
+        }
+        if (pid == 0)
+        {
+            exec(args[0], args);
+            printf(1, "exec %s failed\n", args[0]);
+            exit();
+        }
+        wait();
+    }
+    cycles = rdtsc() - start;
+    n = uptime() - n;
+    printf(1, "fork()+exec(): %d rounds in %d ticks, %d Kcycles", rounds, n, (uint)(cycles >> 10));
+    printf(1, ", %d cycles/round\n", percycles(cycles, rounds));
+
+    exit();
+}
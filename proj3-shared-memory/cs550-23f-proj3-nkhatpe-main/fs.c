@@ -267,6 +267,7 @@ iget(uint dev, uint inum)
   ip->inum = inum;
   ip->ref = 1;
   ip->valid = 0;
+  ip->cached = 1;  // its pages may have outlived the last in-memory copy
   release(&icache.lock);
 
   return ip;
@@ -283,6 +284,31 @@ idup(struct inode *ip)
   return ip;
 }
 
+// Take a reference to ip for a process running the program in it.
+// Its pages are read from ip on first touch, so writei() refuses to
+// change ip while any process runs it.
+// Caller must hold ip->lock, or another iexec() reference.
+struct inode*
+iexec(struct inode *ip)
+{
+  acquire(&icache.lock);
+  ip->ref++;
+  ip->nexec++;
+  release(&icache.lock);
+  return ip;
+}
+
+// Drop a reference taken by iexec().
+// Must be called inside a transaction, as iput() is.
+void
+iunexec(struct inode *ip)
+{
+  acquire(&icache.lock);
+  ip->nexec--;
+  release(&icache.lock);
+  iput(ip);
+}
+
 // Lock the given inode.
 // Reads the inode from disk if necessary.
 void
@@ -412,6 +438,7 @@ itrunc(struct inode *ip)
   struct buf *bp;
   uint *a;
 
+  pcinval(ip);
   for(i = 0; i < NDIRECT; i++){
     if(ip->addrs[i]){
       bfree(ip->dev, ip->addrs[i]);
@@ -495,7 +522,10 @@ writei(struct inode *ip, char *src, uint off, uint n)
     return -1;
   if(off + n > MAXFILE*BSIZE)
     return -1;
+  if(ip->nexec > 0)
+    return -1;  // a running program still reads its pages from ip
 
+  pcinval(ip);
   for(tot=0; tot<n; tot+=m, off+=m, src+=m){
     bp = bread(ip->dev, bmap(ip, off/BSIZE));
     m = min(n - tot, BSIZE - off%BSIZE);
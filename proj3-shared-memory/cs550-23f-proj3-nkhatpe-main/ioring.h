@@ -0,0 +1,40 @@
+// Submission/completion ring for batched file and pipe I/O.
+//
+// get_shared_page_addr(2) maps a struct io_ring into the calling
+// process and returns its address. The process queues operations by
+// filling sq[sq_tail % IORING_SQES] and advancing sq_tail, then makes
+// one submit(n) call to have the kernel carry out up to n of them in
+// order. For each operation the kernel advances sq_head and posts a
+// completion at cq[cq_tail % IORING_CQES]; the process reads the
+// completions and advances cq_head. The kernel stops early when the
+// completion queue is full.
+
+#define IORING_OP_READ  1   // read(fd, addr, len)
+#define IORING_OP_WRITE 2   // write(fd, addr, len)
+#define IORING_OP_OPEN  3   // open(addr, len), where len is the mode
+#define IORING_OP_CLOSE 4   // close(fd)
+
+struct io_sqe {
+  int op;          // IORING_OP_*
+  int fd;
+  char *addr;      // Buffer, or path for IORING_OP_OPEN
+  int len;
+  uint data;       // Copied to the completion
+};
+
+struct io_cqe {
+  uint data;       // From the submission
+  int res;         // What the system call would have returned
+};
+
+#define IORING_SQES 128
+#define IORING_CQES 128
+
+struct io_ring {
+  volatile uint sq_head;   // Written by the kernel
+  volatile uint sq_tail;   // Written by the process
+  volatile uint cq_head;   // Written by the process
+  volatile uint cq_tail;   // Written by the kernel
+  struct io_sqe sq[IORING_SQES];
+  struct io_cqe cq[IORING_CQES];
+};
@@ -21,6 +21,7 @@ struct {
   struct spinlock lock;
   int use_lock;
   struct run *freelist;
+  uchar ref[PHYSTOP / PGSIZE]; // mappings of each frame; see copyuvm()
 } kmem;
 
 int free_frame_cnt = 0; // OS project: memory management
@@ -67,6 +68,20 @@ kfree(char *v)
   if((uint)v % PGSIZE || v < end || V2P(v) >= PHYSTOP)
     panic("kfree");
 
+  // A frame shared copy-on-write is only freed by its last mapper.
+  // Frames handed over by freerange() start with no references.
+  if(kmem.use_lock)
+    acquire(&kmem.lock);
+  if(kmem.ref[V2P(v) / PGSIZE] > 1){
+    kmem.ref[V2P(v) / PGSIZE]--;
+    if(kmem.use_lock)
+      release(&kmem.lock);
+    return;
+  }
+  kmem.ref[V2P(v) / PGSIZE] = 0;
+  if(kmem.use_lock)
+    release(&kmem.lock);
+
   // Fill with junk to catch dangling refs.
   memset(v, 1, PGSIZE);
 
@@ -94,6 +109,7 @@ kalloc(void)
   if(r)
   {
     kmem.freelist = r->next;
+    kmem.ref[V2P(r) / PGSIZE] = 1;
     free_frame_cnt--; // OS project: memory management
   }
   if(kmem.use_lock)
@@ -101,3 +117,39 @@ kalloc(void)
   return (char*)r;
 }
 
+// Add a mapping of the page at v, which must have come from kalloc().
+// Returns -1 if the page already has as many mappings as its count holds.
+int
+kref(char *v)
+{
+  int r = 0;
+
+  if((uint)v % PGSIZE || v < end || V2P(v) >= PHYSTOP)
+    panic("kref");
+  if(kmem.use_lock)
+    acquire(&kmem.lock);
+  if(kmem.ref[V2P(v) / PGSIZE] == 0)
+    panic("kref: free page");
+  if(kmem.ref[V2P(v) / PGSIZE] == 255)
+    r = -1;
+  else
+    kmem.ref[V2P(v) / PGSIZE]++;
+  if(kmem.use_lock)
+    release(&kmem.lock);
+  return r;
+}
+
+// Return the number of mappings of the page at v.
+int
+krefcnt(char *v)
+{
+  int n;
+
+  if(kmem.use_lock)
+    acquire(&kmem.lock);
+  n = kmem.ref[V2P(v) / PGSIZE];
+  if(kmem.use_lock)
+    release(&kmem.lock);
+  return n;
+}
+
@@ -27,6 +27,8 @@ main(void)
   consoleinit();   // console hardware
   uartinit();      // serial port
   pinit();         // process table
+  shminit();       // shared memory segments
+  pcacheinit();    // executable page cache
   tvinit();        // trap vectors
   binit();         // buffer cache
   fileinit();      // file table
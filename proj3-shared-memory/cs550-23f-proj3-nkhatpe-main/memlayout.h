@@ -8,6 +8,10 @@
 #define KERNBASE 0x80000000         // First kernel virtual address
 #define KERNLINK (KERNBASE+EXTMEM)  // Address where kernel is linked
 
+// Pages mapped on request above user memory, just below KERNBASE.
+#define IORINGVA (KERNBASE-0x1000)  // I/O submission ring (ioring.h)
+#define USERTOP  IORINGVA           // First address above user memory
+
 #define V2P(a) (((uint) (a)) - KERNBASE)
 #define P2V(a) (((void *) (a)) + KERNBASE)
 
@@ -11,4 +11,9 @@
 #define LOGSIZE      (MAXOPBLOCKS*3)  // max data blocks in on-disk log
 #define NBUF         (MAXOPBLOCKS*3)  // size of disk block cache
 #define FSSIZE       1000  // size of file system in blocks
-
+#define NSHM         16  // maximum number of shared memory segments
+#define SHMMAXPG     64  // maximum pages in a shared memory segment
+#define SHMNAME      16  // maximum length of a segment name, with the nul
+#define NSHMATT       8  // segments a process can have attached
+#define NEXECSEG      4  // loadable ELF segments exec() can page in
+#define NPCACHE     128  // pages in the executable page cache
@@ -0,0 +1,113 @@
+// Page cache for executables.
+//
+// exec() leaves a program's pages to be read from its inode on first
+// touch (see execfault() in proc.c). Whole pages of the file come from
+// this cache, so every process running the same program maps the same
+// frames; they are mapped copy-on-write, and only pages a process
+// writes get copies of their own. The cache holds a kalloc() reference
+// to each frame it keeps, as does every page table mapping it.
+//
+// A file some process is running cannot be written (see iexec()), as
+// the pages it has not touched yet are still to be read from it.
+// Writing to or truncating a file drops its pages from the cache.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "mmu.h"
+#include "spinlock.h"
+#include "sleeplock.h"
+#include "fs.h"
+#include "file.h"
+
+struct pcpage {
+  uint dev;
+  uint inum;
+  uint off;                    // Offset of the page in the file
+  char *frame;                 // 0 if the slot is free
+};
+
+struct {
+  struct spinlock lock;
+  struct pcpage page[NPCACHE];
+  uint hand;                   // Next slot to evict when all are in use
+} pcache;
+
+void
+pcacheinit(void)
+{
+  initlock(&pcache.lock, "pcache");
+}
+
+// Return a frame holding the page of ip at off, with a reference
+// added for the caller, reading it if it is not cached.
+// Caller must hold ip's lock. Returns 0 on failure.
+char*
+pcget(struct inode *ip, uint off)
+{
+  struct pcpage *p;
+  char *mem, *copy;
+
+  acquire(&pcache.lock);
+  for(p = pcache.page; p < &pcache.page[NPCACHE]; p++){
+    if(p->frame && p->dev == ip->dev && p->inum == ip->inum && p->off == off){
+      mem = p->frame;
+      if(kref(mem) == 0){
+        release(&pcache.lock);
+        return mem;
+      }
+      // Too many sharers; hand the caller a copy.
+      if((copy = kalloc()) != 0)
+        memmove(copy, mem, PGSIZE);
+      release(&pcache.lock);
+      return copy;
+    }
+  }
+  release(&pcache.lock);
+
+  // Holding ip's lock keeps anyone else from adding this page meanwhile.
+  if((mem = kalloc()) == 0)
+    return 0;
+  if(readi(ip, mem, off, PGSIZE) != PGSIZE){
+    kfree(mem);
+    return 0;
+  }
+
+  acquire(&pcache.lock);
+  for(p = pcache.page; p < &pcache.page[NPCACHE]; p++)
+    if(p->frame == 0)
+      break;
+  if(p == &pcache.page[NPCACHE]){
+    p = &pcache.page[pcache.hand++ % NPCACHE];
+    kfree(p->frame);
+  }
+  kref(mem);
+  ip->cached = 1;
+  p->dev = ip->dev;
+  p->inum = ip->inum;
+  p->off = off;
+  p->frame = mem;
+  release(&pcache.lock);
+  return mem;
+}
+
+// Drop the cached pages of ip, whose contents are changing.
+// Caller must hold ip's lock.
+void
+pcinval(struct inode *ip)
+{
+  struct pcpage *p;
+
+  // Most files were never run; skip the scan for them.
+  if(!ip->cached)
+    return;
+  ip->cached = 0;
+  acquire(&pcache.lock);
+  for(p = pcache.page; p < &pcache.page[NPCACHE]; p++){
+    if(p->frame && p->dev == ip->dev && p->inum == ip->inum){
+      kfree(p->frame);
+      p->frame = 0;
+    }
+  }
+  release(&pcache.lock);
+}
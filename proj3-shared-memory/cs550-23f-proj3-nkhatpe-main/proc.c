@@ -12,6 +12,11 @@ struct {
   struct proc proc[NPROC];
 } ptable;
 
+struct {
+  struct spinlock lock;
+  struct dmsmp dmsmp[NPROC];
+} dmsmptable;
+
 static struct proc *initproc;
 
 int nextpid = 1;
@@ -24,6 +29,7 @@ void
 pinit(void)
 {
   initlock(&ptable.lock, "ptable");
+  initlock(&dmsmptable.lock, "dmsmptable");
 }
 
 // Must be called with interrupts disabled
@@ -161,13 +167,26 @@ int
 growproc(int n)
 {
   uint sz;
+  int pages;
   struct proc *curproc = myproc();
 
   sz = curproc->sz;
   if(n > 0){
-    if((sz = allocuvm(curproc->pgdir, sz, sz + n)) == 0)
+    // Only move sz; pagefault() maps each page on its first touch.
+    // Refuse to promise more pages than are free, so that malloc()
+    // still fails when memory runs out. The check is per process, not
+    // a reservation: a touch that finds no frame kills the process.
+    if(sz + n < sz || sz + n > USERTOP || shmoverlap(curproc, PGROUNDUP(sz), sz + n))
+      return -1;
+    pages = (PGROUNDUP(sz + n) - PGROUNDUP(sz)) / PGSIZE;
+    if(curproc->lazypg + pages > free_frame_cnt)
       return -1;
+    curproc->lazypg += pages;
+    sz += n;
   } else if(n < 0){
+    curproc->lazypg -= unmapped(curproc->pgdir, PGROUNDUP(sz + n), PGROUNDUP(sz));
+    if(curproc->lazypg < 0)
+      curproc->lazypg = 0;
     if((sz = deallocuvm(curproc->pgdir, sz, sz + n)) == 0)
       return -1;
   }
@@ -201,6 +220,30 @@ fork(void)
   np->sz = curproc->sz;
   np->parent = curproc;
 
+  // Shared memory segments are above sz, so copyuvm() left them out.
+  if(shmfork(np, curproc) < 0){
+    freevm(np->pgdir);
+    np->pgdir = 0;
+    kfree(np->kstack);
+    np->kstack = 0;
+    np->state = UNUSED;
+    return -1;
+  }
+
+  // copyuvm() copies only up to sz, so the child asks for its own I/O ring.
+  np->io_ring = 0;
+
+  // The child shares the parent's shared pages, even a DMSMP neither has touched yet.
+  np->static_page = curproc->static_page;
+  np->dynamic_page = curproc->dynamic_page;
+  np->dmsmp = dmsmpdup(curproc);
+
+  // Pages of the program the parent has not touched are holes to the child too.
+  np->exe = curproc->exe ? iexec(curproc->exe) : 0;
+  for(i = 0; i < NEXECSEG; i++)
+    np->seg[i] = curproc->seg[i];
+  np->lazypg = curproc->lazypg;
+
   *np->tf = *curproc->tf;
 
   // Clear %eax so that fork returns 0 in the child.
@@ -247,8 +290,16 @@ exit(void)
 
   begin_op();
   iput(curproc->cwd);
+  if(curproc->exe)
+    iunexec(curproc->exe);
   end_op();
   curproc->cwd = 0;
+  curproc->exe = 0;
+
+  // The frame itself goes when wait() frees the last page table mapping it.
+  dmsmpput(curproc->dmsmp);
+  curproc->dmsmp = 0;
+  shmdrop(curproc);
 
   acquire(&ptable.lock);
 
@@ -566,8 +617,181 @@ char *get_page_addr(int type)
         // Get the address of the Dynamic Memory Space Management Page (DMSMP)
         addr = (char *)curproc->dynamic_page;
     }
+
+    // Check the type of page requested
+    if (type == 2)
+    {
+        // Map the I/O submission ring on first use; freevm() frees it with the rest of the address space
+        if (curproc->io_ring == 0)
+        {
+            char *mem = kalloc();
+            if (mem == 0)
+                return 0;
+            memset(mem, 0, PGSIZE);
+            if (mappages(curproc->pgdir, (char *)IORINGVA, PGSIZE, V2P(mem), PTE_W | PTE_U) < 0)
+            {
+                kfree(mem);
+                return 0;
+            }
+            curproc->io_ring = (char *)IORINGVA;
+        }
+        addr = curproc->io_ring;
+    }
     
     // Return the obtained address
     return addr;
 }
 
+// Return p's DMSMP, giving p a fresh one if it has none.
+// Caller must hold dmsmptable.lock.
+static struct dmsmp*
+dmsmpof(struct proc *p)
+{
+  struct dmsmp *d;
+
+  if(p->dmsmp)
+    return p->dmsmp;
+  // Each process holds at most one, so there is always a free slot.
+  for(d = dmsmptable.dmsmp; d < &dmsmptable.dmsmp[NPROC]; d++)
+    if(d->ref == 0)
+      break;
+  if(d == &dmsmptable.dmsmp[NPROC])
+    panic("dmsmpof");
+  d->ref = 1;
+  d->frame = 0;
+  p->dmsmp = d;
+  return d;
+}
+
+// Return p's DMSMP with a reference added for a child of p.
+struct dmsmp*
+dmsmpdup(struct proc *p)
+{
+  struct dmsmp *d;
+
+  acquire(&dmsmptable.lock);
+  d = dmsmpof(p);
+  d->ref++;
+  release(&dmsmptable.lock);
+  return d;
+}
+
+// Drop a process's reference to a DMSMP. The frame loses the
+// reference the DMSMP held; page tables still mapping it keep theirs.
+void
+dmsmpput(struct dmsmp *d)
+{
+  if(d == 0)
+    return;
+  acquire(&dmsmptable.lock);
+  if(--d->ref == 0 && d->frame){
+    kfree(d->frame);
+    d->frame = 0;
+  }
+  release(&dmsmptable.lock);
+}
+
+// Handle a fault on the current process's unmapped DMSMP: map the
+// frame shared with its parent and children, allocating it if this
+// is the first touch. Returns -1 if va is not in the DMSMP.
+static int
+dmsmpfault(uint va)
+{
+  struct proc *curproc = myproc();
+  struct dmsmp *d;
+  char *mem;
+
+  if(curproc->dynamic_page == 0 || va >= curproc->sz ||
+     PGROUNDDOWN(va) != (uint)curproc->dynamic_page)
+    return -1;
+
+  acquire(&dmsmptable.lock);
+  d = dmsmpof(curproc);
+  if(d->frame == 0){
+    if((mem = kalloc()) == 0)
+      goto bad;
+    memset(mem, 0, PGSIZE);
+    d->frame = mem;
+  }
+  if(kref(d->frame) < 0)
+    goto bad;
+  // PTE_SHR: fork() shares the mapping instead of copy-on-write.
+  if(mappages(curproc->pgdir, curproc->dynamic_page, PGSIZE, V2P(d->frame),
+              PTE_W|PTE_U|PTE_SHR) < 0){
+    kfree(d->frame);
+    goto bad;
+  }
+  release(&dmsmptable.lock);
+  return 0;
+
+bad:
+  release(&dmsmptable.lock);
+  return -1;
+}
+
+// Map the page at va of segment s of the current process's program.
+// Whole pages of the file come from the page cache, shared
+// copy-on-write; the page holding the end of the file's part gets a
+// private copy, and pages past it are zeroed.
+static int
+execfault(struct execseg *s, uint va)
+{
+  struct proc *curproc = myproc();
+  uint a, n;
+  char *mem;
+  int perm;
+
+  a = PGROUNDDOWN(va);
+  if(a + PGSIZE <= s->va + s->filesz){
+    ilock(curproc->exe);
+    mem = pcget(curproc->exe, s->off + (a - s->va));
+    iunlock(curproc->exe);
+    if(mem == 0)
+      return -1;
+    perm = PTE_U|PTE_COW;
+  } else {
+    if((mem = kalloc()) == 0)
+      return -1;
+    memset(mem, 0, PGSIZE);
+    if(a < s->va + s->filesz){
+      n = s->va + s->filesz - a;
+      ilock(curproc->exe);
+      if(readi(curproc->exe, mem, s->off + (a - s->va), n) != n){
+        iunlock(curproc->exe);
+        kfree(mem);
+        return -1;
+      }
+      iunlock(curproc->exe);
+    }
+    perm = PTE_W|PTE_U;
+  }
+  if(mappages(curproc->pgdir, (char*)a, PGSIZE, V2P(mem), perm) < 0){
+    kfree(mem);
+    return -1;
+  }
+  return 0;
+}
+
+// Handle a fault on a page of the current process that is not
+// present: the DMSMP, a page of the program exec() left to be read
+// in, or a page growproc() left for the first touch. Returns -1 if
+// va is outside the process's memory.
+int
+pagefault(uint va)
+{
+  struct proc *curproc = myproc();
+  struct execseg *s;
+
+  if(va >= curproc->sz)
+    return -1;
+  if(curproc->dynamic_page && PGROUNDDOWN(va) == (uint)curproc->dynamic_page)
+    return dmsmpfault(va);
+  for(s = curproc->seg; s < &curproc->seg[NEXECSEG]; s++)
+    if(s->memsz && va >= s->va && va < s->va + s->memsz)
+      return execfault(s, va);
+  if(lazyalloc(curproc->pgdir, va) < 0)
+    return -1;
+  if(curproc->lazypg > 0)
+    curproc->lazypg--;
+  return 0;
+}
@@ -37,6 +37,27 @@ struct context {
 
 enum procstate { UNUSED, EMBRYO, SLEEPING, RUNNABLE, RUNNING, ZOMBIE };
 
+// Frame behind a DMSMP, shared by a process and the children it
+// forks; allocated on the first fault on the page (see dmsmpfault()).
+struct dmsmp {
+  int ref;                     // Processes holding this page
+  char *frame;                 // Kernel address of the frame, 0 until first touched
+};
+
+// A handle on a shared memory segment, attached at va (see shm.c).
+struct shmatt {
+  struct shm *seg;             // 0 if the slot is free
+  uint va;                     // 0 if not attached
+};
+
+// A loadable ELF segment of exe, paged in on first touch (see execfault()).
+struct execseg {
+  uint va;                     // First address, page aligned
+  uint memsz;                  // 0 if the slot is free
+  uint off;                    // Offset of the segment in exe
+  uint filesz;
+};
+
 // Per-process state
 struct proc {
   uint sz;                     // Size of process memory (bytes)
@@ -54,6 +75,12 @@ struct proc {
   char name[16];               // Process name (debugging)
   char *static_page;    // Pointer to the Static Memory Space Management Page (SMSMP)
   char *dynamic_page;   // Pointer to the Dynamic Memory Space Management Page (DMSMP)
+  char *io_ring;        // Pointer to the I/O submission ring page, 0 until first requested
+  struct dmsmp *dmsmp;  // Frame behind dynamic_page, 0 until first fork or touch
+  struct shmatt shm[NSHMATT];  // Shared memory segment handles
+  int lazypg;           // Pages growproc() promised that are not mapped yet
+  struct inode *exe;    // Program exec() loaded, 0 for initcode
+  struct execseg seg[NEXECSEG];  // Segments of exe
 };
 
 // Process memory is laid out contiguously, low addresses first:
@@ -0,0 +1,150 @@
+/*
+ * I/O ring benchmark: read a file with one read() trap per buffer, then
+ * with the reads queued in the I/O ring and handed to the kernel in
+ * batches with submit().
+ *
+ *   ringbench [buffer size] [batch]
+ */
+#include "types.h"
+#include "user.h"
+#include "fcntl.h"
+#include "ioring.h"
+
+#define FILE_SIZE (64 * 1024)
+#define ROUNDS    20
+#define MAX_BUF   4096
+
+char *file = "ringbench.dat";
+char buf[MAX_BUF];
+
+// Read the file once with read(); returns the bytes read.
+int plain_pass(int bufsize, int *traps)
+{
+    int fd, n, total = 0;
+
+    fd = open(file, O_RDONLY);
+    (*traps)++;
+    while ((n = read(fd, buf, bufsize)) > 0)
+    {
+        total += n;
+        (*traps)++;
+    }
+    (*traps)++;
+    close(fd);
+    (*traps)++;
+    return total;
+}
+
+// Read the file once through the ring, 'batch' reads per submit(),
+// with the open and close queued too; returns the bytes read.
+int ring_pass(struct io_ring *r, int bufsize, int batch, int *traps)
+{
+    struct io_sqe *sqe;
+    struct io_cqe *cqe;
+    int fd, i, total = 0, eof = 0;
+
+    sqe = &r->sq[r->sq_tail % IORING_SQES];
+    sqe->op = IORING_OP_OPEN;
+    sqe->addr = file;
+    sqe->len = O_RDONLY;
+    sqe->data = 0;
+    r->sq_tail++;
+    submit(1);
+    (*traps)++;
+    fd = r->cq[r->cq_head % IORING_CQES].res;
+    r->cq_head++;
+    if (fd < 0)
+    {
+        printf(1, "ring open failed\n");
+        exit();
+    }
+
+    while (!eof)
+    {
+        // All reads go to the same buffer: only the trap count differs.
+        for (i = 0; i < batch; i++)
+        {
+            sqe = &r->sq[r->sq_tail % IORING_SQES];
+            sqe->op = IORING_OP_READ;
+            sqe->fd = fd;
+            sqe->addr = buf;
+            sqe->len = bufsize;
+            sqe->data = i;
+            r->sq_tail++;
+        }
+        submit(batch);
+        (*traps)++;
+        while (r->cq_head != r->cq_tail)
+        {
+            cqe = &r->cq[r->cq_head % IORING_CQES];
+            if (cqe->res <= 0)
+                eof = 1;
+            else
+                total += cqe->res;
+            r->cq_head++;
+        }
+    }
+
+    sqe = &r->sq[r->sq_tail % IORING_SQES];
+    sqe->op = IORING_OP_CLOSE;
+    sqe->fd = fd;
+    sqe->data = 0;
+    r->sq_tail++;
+    submit(1);
+    (*traps)++;
+    r->cq_head++;
+    return total;
+}
+
+void report(char *name, uint64 cycles, int bytes, int traps)
+{
+    int kb = bytes / 1024;
+
+    printf(1, "%s: %d KB in %d Kcycles, %d traps", name, kb, (uint)(cycles >> 10), traps);
+    printf(1, ", %d cycles/KB\n", percycles(cycles, kb));
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct io_ring *r;
+    uint64 start;
+    int fd, i, bufsize, batch, bytes, traps;
+
+    bufsize = argc >= 2 ? atoi(argv[1]) : 512;
+    batch = argc >= 3 ? atoi(argv[2]) : 32;
+    if (bufsize <= 0 || bufsize > MAX_BUF)
+        bufsize = 512;
+    if (batch <= 0 || batch > IORING_SQES)
+        batch = 32;
+
+    r = (struct io_ring *)get_shared_page_addr(2);
+    if (r == 0)
+    {
+        printf(1, "get_shared_page_addr(2) failed\n");
+        exit();
+    }
+
+    fd = open(file, O_CREATE | O_RDWR);
+    memset(buf, 'x', sizeof(buf));
+    for (i = 0; i < FILE_SIZE; i += sizeof(buf))
+        write(fd, buf, sizeof(buf));
+    close(fd);
+
+    printf(1, "%d-byte buffers, %d reads per submit, %d passes\n", bufsize, batch, ROUNDS);
+
+    bytes = traps = 0;
+    start = rdtsc();
+    for (i = 0; i < ROUNDS; i++)
+        bytes += plain_pass(bufsize, &traps);
+    report("read()", rdtsc() - start, bytes, traps);
+
+    bytes = traps = 0;
+    start = rdtsc();
+    for (i = 0; i < ROUNDS; i++)
+        bytes += ring_pass(r, bufsize, batch, &traps);
+    report("submit()", rdtsc() - start, bytes, traps);
+
+    unlink(file);
+    exit();
+}
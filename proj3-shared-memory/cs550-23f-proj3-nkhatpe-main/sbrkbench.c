@@ -0,0 +1,116 @@
+/*
+ * Lazy sbrk benchmark: the frames and cycles a first malloc() and a
+ * large sbrk() cost before and after their pages are touched, the cost
+ * of faulting the pages in, and the footprint and run time of a
+ * program that grows a large heap and touches little of it, as
+ * usertests' sbrktest does.
+ *
+ *   sbrkbench [heap KB]
+ */
+#include "types.h"
+#include "user.h"
+
+#define PGSIZE  4096
+#define HEAP_KB 16384
+
+// Child run by exec(): grow the heap by kb, touch its first and last
+// bytes as sbrktest does, and report the frames that took.
+void bigheap(int kb)
+{
+    char *heap;
+    int f0;
+
+    f0 = get_free_frame_cnt();
+    heap = sbrk(kb * 1024);
+    if (heap == (char *)-1)
+    {
+        printf(1, "sbrk(%d KB) failed\n", kb);
+        exit();
+    }
+    heap[0] = 1;
+    heap[kb * 1024 - 1] = 1;
+    printf(1, "program with a %d KB heap: %d frames\n", kb, f0 - get_free_frame_cnt());
+    exit();
+}
+
+int
+main(int argc, char *argv[])
+{
+    char *p, *heap, *args[4], kbstr[12];
+    uint64 start, cycles;
+    int kb, pages, i, n, f0, f1, f2;
+
+    if (argc >= 3 && strcmp(argv[1], "-c") == 0)
+        bigheap(atoi(argv[2]));
+
+    kb = argc >= 2 ? atoi(argv[1]) : HEAP_KB;
+    if (kb <= 0)
+        kb = HEAP_KB;
+    pages = kb * 1024 / PGSIZE;
+
+    // morecore() asks for at least 4096 headers (32 KB) at a time, and
+    // malloc() writes headers at both ends of it: the first page and
+    // the last, where the block it returns lies.
+    f0 = get_free_frame_cnt();
+    p = malloc(16);
+    f1 = get_free_frame_cnt();
+    printf(1, "malloc(16): heap grew 32 KB (8 pages), %d frames\n", f0 - f1);
+
+    // A block of several pages has pages no header is written to.
+    f0 = get_free_frame_cnt();
+    p = malloc(8 * PGSIZE);
+    f1 = get_free_frame_cnt();
+    p[4 * PGSIZE] = 1;
+    f2 = get_free_frame_cnt();
+    printf(1, "malloc(32 KB): %d frames, %d more after writing to a middle page\n", f0 - f1, f1 - f2);
+
+    f0 = get_free_frame_cnt();
+    start = rdtsc();
+    heap = sbrk(kb * 1024);
+    cycles = rdtsc() - start;
+    if (heap == (char *)-1)
+    {
+        printf(1, "sbrk(%d KB) failed\n", kb);
+        exit();
+    }
+    f1 = get_free_frame_cnt();
+    printf(1, "sbrk(%d KB): %d frames, %d Kcycles\n", kb, f0 - f1, (uint)(cycles >> 10));
+
+    // Touch one page in eight, as a sparse heap would.
+    start = rdtsc();
+    for (i = 0; i < pages; i += 8)
+        heap[i * PGSIZE] = 1;
+    cycles = rdtsc() - start;
+    f2 = get_free_frame_cnt();
+    printf(1, "touching %d of %d pages: %d frames, %d cycles/page\n", (pages + 7) / 8, pages,
+           f1 - f2, percycles(cycles, (pages + 7) / 8));
+
+    for (i = 0; i < pages; i++)
+        heap[i * PGSIZE] = 1;
+    printf(1, "touching all %d pages: %d frames in total\n", pages, f0 - get_free_frame_cnt());
+
+    sbrk(-kb * 1024);
+    printf(1, "after sbrk(-%d KB): %d frames still held\n", kb, f0 - get_free_frame_cnt());
+
+    // A fresh program growing a big heap, from fork() to its exit.
+    i = sizeof(kbstr) - 1;
+    kbstr[i] = 0;
+    for (n = kb; i == sizeof(kbstr) - 1 || n > 0; n /= 10)
+        kbstr[--i] = '0' + n % 10;
+    args[0] = argv[0];
+    args[1] = "-c";
+    args[2] = kbstr + i;
+    args[3] = 0;
+    start = rdtsc();
+    if (fork() == 0)
+    {
+        exec(args[0], args);
+        printf(1, "exec %s failed\n", args[0]);
+        exit();
+    }
+    wait();
+    cycles = rdtsc() - start;
+    printf(1, "fork()+exec() of it until it exits: %d Kcycles\n", (uint)(cycles >> 10));
+
+    exit();
+}
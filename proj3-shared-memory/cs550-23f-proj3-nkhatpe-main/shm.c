@@ -0,0 +1,267 @@
+// Named shared memory segments.
+//
+// shm_open() finds a segment by name or creates it with npages zeroed
+// frames, and returns a handle to it: a slot of the caller's shm[]
+// table, as a file descriptor is a slot of its ofile[]. The handle
+// holds a reference to the segment, so its id cannot come to name
+// another segment. shm_attach() maps all of a segment's pages at a
+// page-aligned address the caller picks between the top of its memory
+// and USERTOP. shm_detach() unmaps them and closes the handle;
+// shm_close() closes a handle, attached or not. exec() and exit() close
+// every handle, and a segment lives until its last handle is closed.
+//
+// Every page table mapping a frame holds a kalloc() reference to it,
+// as does the segment, so freevm() and the segment free it between
+// them in whichever order they come. fork() gives the child a copy of
+// every handle, attached at the same addresses.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "proc.h"
+#include "spinlock.h"
+
+struct shm {
+  char name[SHMNAME];
+  int npages;                  // 0 if the slot is free
+  int ref;                     // Handles open on it
+  char *frame[SHMMAXPG];
+};
+
+struct {
+  struct spinlock lock;
+  struct shm shm[NSHM];
+} shmtable;
+
+void
+shminit(void)
+{
+  initlock(&shmtable.lock, "shmtable");
+}
+
+// Free a segment's frames once no handle is open on it.
+// Caller must hold shmtable.lock.
+static void
+shmput(struct shm *s)
+{
+  int i;
+
+  if(--s->ref > 0)
+    return;
+  for(i = 0; i < s->npages; i++)
+    kfree(s->frame[i]);
+  s->npages = 0;
+  s->name[0] = 0;
+}
+
+// Map s's pages at va in pgdir, adding a frame reference for each.
+// Caller must hold shmtable.lock.
+static int
+shmmap(pde_t *pgdir, struct shm *s, uint va)
+{
+  int i;
+
+  for(i = 0; i < s->npages; i++){
+    if(kref(s->frame[i]) < 0)
+      goto bad;
+    if(mappages(pgdir, (char*)va + i*PGSIZE, PGSIZE, V2P(s->frame[i]), PTE_W|PTE_U) < 0){
+      kfree(s->frame[i]);
+      goto bad;
+    }
+  }
+  return 0;
+
+bad:
+  deallocuvm(pgdir, va + i*PGSIZE, va);
+  return -1;
+}
+
+// Open a handle on the segment called name, creating it with npages
+// pages if there is none. npages 0 opens an existing segment only.
+// Returns the handle's id, or -1.
+int
+shmopen(char *name, int npages)
+{
+  struct proc *curproc = myproc();
+  struct shmatt *a;
+  struct shm *s, *free;
+  int i;
+
+  if(npages < 0 || npages > SHMMAXPG || name[0] == 0 || strlen(name) >= SHMNAME)
+    return -1;
+  for(a = curproc->shm; a < &curproc->shm[NSHMATT]; a++)
+    if(a->seg == 0)
+      break;
+  if(a == &curproc->shm[NSHMATT])
+    return -1;
+
+  acquire(&shmtable.lock);
+  free = 0;
+  for(s = shmtable.shm; s < &shmtable.shm[NSHM]; s++){
+    if(s->npages == 0){
+      if(free == 0)
+        free = s;
+      continue;
+    }
+    if(strncmp(s->name, name, SHMNAME) == 0){
+      if(npages != 0 && npages != s->npages){
+        release(&shmtable.lock);
+        return -1;
+      }
+      goto found;
+    }
+  }
+  if(npages == 0 || (s = free) == 0){
+    release(&shmtable.lock);
+    return -1;
+  }
+
+  for(i = 0; i < npages; i++){
+    if((s->frame[i] = kalloc()) == 0){
+      while(--i >= 0)
+        kfree(s->frame[i]);
+      release(&shmtable.lock);
+      return -1;
+    }
+    memset(s->frame[i], 0, PGSIZE);
+  }
+  safestrcpy(s->name, name, SHMNAME);
+  s->npages = npages;
+  s->ref = 0;
+
+found:
+  s->ref++;
+  a->seg = s;
+  a->va = 0;
+  release(&shmtable.lock);
+  return a - curproc->shm;
+}
+
+// Return 1 if any segment p has attached overlaps [start, end).
+int
+shmoverlap(struct proc *p, uint start, uint end)
+{
+  struct shmatt *a;
+
+  for(a = p->shm; a < &p->shm[NSHMATT]; a++)
+    if(a->seg && a->va && start < a->va + a->seg->npages*PGSIZE && a->va < end)
+      return 1;
+  return 0;
+}
+
+// Attach the segment of the current process's handle id at va.
+// Returns va, or 0 on failure.
+char*
+shmattach(int id, uint va)
+{
+  struct proc *curproc = myproc();
+  struct shmatt *a;
+  uint end;
+
+  if(id < 0 || id >= NSHMATT || va % PGSIZE || va < PGROUNDUP(curproc->sz))
+    return 0;
+  a = &curproc->shm[id];
+  if(a->seg == 0 || a->va != 0)
+    return 0;
+
+  acquire(&shmtable.lock);
+  end = va + a->seg->npages*PGSIZE;
+  if(end < va || end > USERTOP || shmoverlap(curproc, va, end) ||
+     shmmap(curproc->pgdir, a->seg, va) < 0){
+    release(&shmtable.lock);
+    return 0;
+  }
+  a->va = va;
+  release(&shmtable.lock);
+  return (char*)va;
+}
+
+// Unmap the segment of handle a if it is attached, and close a.
+// Caller must hold shmtable.lock.
+static void
+shmclose1(struct proc *p, struct shmatt *a)
+{
+  if(a->va)
+    deallocuvm(p->pgdir, a->va + a->seg->npages*PGSIZE, a->va);
+  shmput(a->seg);
+  a->seg = 0;
+  a->va = 0;
+}
+
+// Close the current process's handle id.
+int
+shmclose(int id)
+{
+  struct proc *curproc = myproc();
+
+  if(id < 0 || id >= NSHMATT || curproc->shm[id].seg == 0)
+    return -1;
+  acquire(&shmtable.lock);
+  shmclose1(curproc, &curproc->shm[id]);
+  release(&shmtable.lock);
+  switchuvm(curproc);
+  return 0;
+}
+
+// Detach the segment the current process attached at va, closing
+// its handle.
+int
+shmdetach(uint va)
+{
+  struct proc *curproc = myproc();
+  struct shmatt *a;
+
+  if(va == 0)
+    return -1;
+  for(a = curproc->shm; a < &curproc->shm[NSHMATT]; a++)
+    if(a->seg && a->va == va)
+      return shmclose(a - curproc->shm);
+  return -1;
+}
+
+// Give child np a copy of every handle p has, attached where p's is.
+int
+shmfork(struct proc *np, struct proc *p)
+{
+  int i;
+
+  for(i = 0; i < NSHMATT; i++){
+    np->shm[i].seg = 0;
+    np->shm[i].va = 0;
+  }
+
+  acquire(&shmtable.lock);
+  for(i = 0; i < NSHMATT; i++){
+    if(p->shm[i].seg == 0)
+      continue;
+    if(p->shm[i].va && shmmap(np->pgdir, p->shm[i].seg, p->shm[i].va) < 0){
+      release(&shmtable.lock);
+      shmdrop(np);
+      return -1;
+    }
+    p->shm[i].seg->ref++;
+    np->shm[i] = p->shm[i];
+  }
+  release(&shmtable.lock);
+  return 0;
+}
+
+// Close p's handles when its address space goes away in exec()
+// or exit(). The caller's freevm() releases the page table's frames.
+void
+shmdrop(struct proc *p)
+{
+  struct shmatt *a;
+
+  acquire(&shmtable.lock);
+  for(a = p->shm; a < &p->shm[NSHMATT]; a++){
+    if(a->seg){
+      shmput(a->seg);
+      a->seg = 0;
+      a->va = 0;
+    }
+  }
+  release(&shmtable.lock);
+}
@@ -0,0 +1,176 @@
+/*
+ * Shared memory segment benchmark: a producer passes data to a consumer
+ * through a pipe, then through a ring of slots in a named segment the
+ * two attach on their own with shm_open()/shm_attach().
+ *
+ * Each side spins while the ring is full or empty, in case the other is
+ * running on another CPU, and then sleeps a tick: sleep(0) returns at
+ * once without giving up the CPU, so on one CPU spinning alone would
+ * wait out the whole quantum every time.
+ *
+ *   shmbench [KB]
+ */
+#include "types.h"
+#include "user.h"
+
+#define PGSIZE   4096
+#define SEGNAME  "shmbench"
+#define SEGPAGES 16
+#define SEGVA    0x40000000
+#define NSLOT    (SEGPAGES - 1)   // the first page holds the indexes
+#define TOTAL_KB 4096
+#define SPINS    100000   // polls of the ring before sleeping a tick
+
+// First page of the segment; slot i is page i + 1.
+struct chan {
+    volatile uint head;   // chunks produced
+    volatile uint tail;   // chunks consumed
+};
+
+char buf[PGSIZE];
+
+// Attach the segment by name, as an unrelated process would.
+struct chan *attach(void)
+{
+    int id;
+    char *seg;
+
+    if ((id = shm_open(SEGNAME, SEGPAGES)) < 0 || (seg = shm_attach(id, (void *)SEGVA)) == 0)
+    {
+        printf(1, "shm_open/shm_attach failed\n");
+        exit();
+    }
+    return (struct chan *)seg;
+}
+
+// Wait until *v is no longer equal to old.
+void await(volatile uint *v, uint old)
+{
+    int n;
+
+    for (n = 0; *v == old; n++)
+    {
+        if (n == SPINS)
+        {
+            sleep(1);
+            n = 0;
+        }
+    }
+}
+
+void produce_pipe(int fd, int chunks)
+{
+    int i;
+
+    for (i = 0; i < chunks; i++)
+    {
+        memset(buf, i, PGSIZE);
+        write(fd, buf, PGSIZE);
+    }
+}
+
+int consume_pipe(int fd, int chunks)
+{
+    int n, got, bad = 0, i;
+
+    for (i = 0; i < chunks; i++)
+    {
+        for (got = 0; got < PGSIZE; got += n)
+            if ((n = read(fd, buf + got, PGSIZE - got)) <= 0)
+                return -1;
+        if (buf[0] != (char)i || buf[PGSIZE - 1] != (char)i)
+            bad++;
+    }
+    return bad;
+}
+
+void produce_shm(struct chan *c, int chunks)
+{
+    int i;
+
+    for (i = 0; i < chunks; i++)
+    {
+        if (c->head - c->tail == NSLOT)
+            await(&c->tail, c->head - NSLOT);
+        memset((char *)c + (1 + i % NSLOT) * PGSIZE, i, PGSIZE);
+        __sync_synchronize();
+        c->head++;
+    }
+}
+
+int consume_shm(struct chan *c, int chunks)
+{
+    int bad = 0, i;
+
+    for (i = 0; i < chunks; i++)
+    {
+        await(&c->head, c->tail);
+        __sync_synchronize();
+        memmove(buf, (char *)c + (1 + i % NSLOT) * PGSIZE, PGSIZE);
+        if (buf[0] != (char)i || buf[PGSIZE - 1] != (char)i)
+            bad++;
+        __sync_synchronize();
+        c->tail++;
+    }
+    return bad;
+}
+
+void report(char *name, int kb, uint64 cycles, int ticks, int bad)
+{
+    uint mcycles = (uint)(cycles >> 20);
+
+    printf(1, "%s: %d KB in %d ticks, %d Mcycles", name, kb, ticks, mcycles);
+    if (mcycles > 0)
+        printf(1, ", %d KB/Mcycle", kb / mcycles);
+    printf(1, bad ? ", %d chunks corrupted ***FAILED***\n" : "\n", bad);
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct chan *c;
+    uint64 start;
+    int kb, chunks, fds[2], t, bad;
+
+    kb = argc >= 2 ? atoi(argv[1]) : TOTAL_KB;
+    if (kb <= 0)
+        kb = TOTAL_KB;
+    chunks = kb / (PGSIZE / 1024);
+
+    if (pipe(fds) < 0)
+    {
+        printf(1, "pipe() failed!\n");
+        exit();
+    }
+    start = rdtsc();
+    t = uptime();
+    if (fork() == 0)
+    {
+        close(fds[0]);
+        produce_pipe(fds[1], chunks);
+        exit();
+    }
+    close(fds[1]);
+    bad = consume_pipe(fds[0], chunks);
+    close(fds[0]);
+    wait();
+    report("pipe", kb, rdtsc() - start, uptime() - t, bad);
+
+    c = attach();
+    start = rdtsc();
+    t = uptime();
+    if (fork() == 0)
+    {
+        // Drop the copy fork() attached and attach again by name.
+        shm_detach(c);
+        c = attach();
+        produce_shm(c, chunks);
+        exit();
+    }
+    bad = consume_shm(c, chunks);
+    wait();
+    report("shm", kb, rdtsc() - start, uptime() - t, bad);
+    shm_detach(c);
+
+    exit();
+}
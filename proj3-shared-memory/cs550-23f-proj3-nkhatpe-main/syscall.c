@@ -14,6 +14,8 @@
 // to a saved program counter, and then the first argument.
 
 // Fetch the int at addr from the current process.
+// Its pages are faulted in first, as argptr() does, so that running
+// out of memory fails the call instead of faulting in the kernel.
 int
 fetchint(uint addr, int *ip)
 {
@@ -21,6 +23,8 @@ fetchint(uint addr, int *ip)
 
   if(addr >= curproc->sz || addr+4 > curproc->sz)
     return -1;
+  if(pagein(addr, 4, 0) < 0)
+    return -1;
   *ip = *(int*)(addr);
   return 0;
 }
@@ -28,6 +32,7 @@ fetchint(uint addr, int *ip)
 // Fetch the nul-terminated string at addr from the current process.
 // Doesn't actually copy the string - just sets *pp to point at it.
 // Returns length of string, not including nul.
+// Each page is faulted in before it is read, as in fetchint().
 int
 fetchstr(uint addr, char **pp)
 {
@@ -39,6 +44,8 @@ fetchstr(uint addr, char **pp)
   *pp = (char*)addr;
   ep = (char*)curproc->sz;
   for(s = *pp; s < ep; s++){
+    if((s == *pp || (uint)s % PGSIZE == 0) && pagein((uint)s, 1, 0) < 0)
+      return -1;
     if(*s == 0)
       return s - *pp;
   }
@@ -54,9 +61,11 @@ argint(int n, int *ip)
 
 // Fetch the nth word-sized system call argument as a pointer
 // to a block of memory of size bytes.  Check that the pointer
-// lies within the process address space.
+// lies within the process address space, and make its pages
+// present, and private and writable if the caller will write
+// the block.
 int
-argptr(int n, char **pp, int size)
+argptr(int n, char **pp, int size, int write)
 {
   int i;
   struct proc *curproc = myproc();
@@ -65,6 +74,8 @@ argptr(int n, char **pp, int size)
     return -1;
   if(size < 0 || (uint)i >= curproc->sz || (uint)i+size > curproc->sz)
     return -1;
+  if(pagein(i, size, write) < 0)
+    return -1;
   *pp = (char*)i;
   return 0;
 }
@@ -106,6 +117,11 @@ extern int sys_uptime(void);
 extern int sys_shutdown(void);
 extern int sys_get_free_frame_cnt(void);
 extern int sys_get_shared_page_addr(void); // External declaration for the system call sys_get_shared_page_addr
+extern int sys_submit(void);
+extern int sys_shm_open(void);
+extern int sys_shm_attach(void);
+extern int sys_shm_detach(void);
+extern int sys_shm_close(void);
 static int (*syscalls[])(void) = {
 [SYS_fork]    sys_fork,
 [SYS_exit]    sys_exit,
@@ -131,6 +147,11 @@ static int (*syscalls[])(void) = {
 [SYS_shutdown]      sys_shutdown,
 [SYS_get_free_frame_cnt]  sys_get_free_frame_cnt,
 [SYS_get_shared_page_addr] sys_get_shared_page_addr, // System call declaration for SYS_get_shared_page_addr
+[SYS_submit]  sys_submit,
+[SYS_shm_open]    sys_shm_open,
+[SYS_shm_attach]  sys_shm_attach,
+[SYS_shm_detach]  sys_shm_detach,
+[SYS_shm_close]   sys_shm_close,
 };
 
 void
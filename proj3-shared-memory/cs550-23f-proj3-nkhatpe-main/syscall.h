@@ -22,4 +22,9 @@
 #define SYS_close  21
 #define SYS_shutdown     22
 #define SYS_get_free_frame_cnt 23
-#define SYS_get_shared_page_addr 24
\ No newline at end of file
+#define SYS_get_shared_page_addr 24
+#define SYS_submit 25
+#define SYS_shm_open 26
+#define SYS_shm_attach 27
+#define SYS_shm_detach 28
+#define SYS_shm_close 29
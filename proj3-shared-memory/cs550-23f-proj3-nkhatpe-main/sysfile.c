@@ -15,6 +15,8 @@
 #include "sleeplock.h"
 #include "file.h"
 #include "fcntl.h"
+#include "memlayout.h"
+#include "ioring.h"
 
 // Fetch the nth word-sized system call argument as a file descriptor
 // and return both the descriptor and the corresponding struct file.
@@ -73,7 +75,7 @@ sys_read(void)
   int n;
   char *p;
 
-  if(argfd(0, 0, &f) < 0 || argint(2, &n) < 0 || argptr(1, &p, n) < 0)
+  if(argfd(0, 0, &f) < 0 || argint(2, &n) < 0 || argptr(1, &p, n, 1) < 0)
     return -1;
   return fileread(f, p, n);
 }
@@ -85,7 +87,7 @@ sys_write(void)
   int n;
   char *p;
 
-  if(argfd(0, 0, &f) < 0 || argint(2, &n) < 0 || argptr(1, &p, n) < 0)
+  if(argfd(0, 0, &f) < 0 || argint(2, &n) < 0 || argptr(1, &p, n, 0) < 0)
     return -1;
   return filewrite(f, p, n);
 }
@@ -109,7 +111,7 @@ sys_fstat(void)
   struct file *f;
   struct stat *st;
 
-  if(argfd(0, 0, &f) < 0 || argptr(1, (void*)&st, sizeof(*st)) < 0)
+  if(argfd(0, 0, &f) < 0 || argptr(1, (void*)&st, sizeof(*st), 1) < 0)
     return -1;
   return filestat(f, st);
 }
@@ -283,17 +285,14 @@ create(char *path, short type, short major, short minor)
   return ip;
 }
 
-int
-sys_open(void)
+// Open path with omode and return a new file descriptor for it.
+static int
+openpath(char *path, int omode)
 {
-  char *path;
-  int fd, omode;
+  int fd;
   struct file *f;
   struct inode *ip;
 
-  if(argstr(0, &path) < 0 || argint(1, &omode) < 0)
-    return -1;
-
   begin_op();
 
   if(omode & O_CREATE){
@@ -333,6 +332,17 @@ sys_open(void)
   return fd;
 }
 
+int
+sys_open(void)
+{
+  char *path;
+  int omode;
+
+  if(argstr(0, &path) < 0 || argint(1, &omode) < 0)
+    return -1;
+  return openpath(path, omode);
+}
+
 int
 sys_mkdir(void)
 {
@@ -427,7 +437,7 @@ sys_pipe(void)
   struct file *rf, *wf;
   int fd0, fd1;
 
-  if(argptr(0, (void*)&fd, 2*sizeof(fd[0])) < 0)
+  if(argptr(0, (void*)&fd, 2*sizeof(fd[0]), 1) < 0)
     return -1;
   if(pipealloc(&rf, &wf) < 0)
     return -1;
@@ -443,3 +453,71 @@ sys_pipe(void)
   fd[1] = fd1;
   return 0;
 }
+
+// Carry out one queued I/O ring operation, checking its arguments
+// the way the system call it stands for would.
+static int
+ioring_op(struct io_sqe *sqe)
+{
+  struct proc *curproc = myproc();
+  struct file *f;
+  char *path;
+
+  f = 0;
+  if(sqe->op != IORING_OP_OPEN){
+    if(sqe->fd < 0 || sqe->fd >= NOFILE || (f=curproc->ofile[sqe->fd]) == 0)
+      return -1;
+  }
+
+  switch(sqe->op){
+  case IORING_OP_READ:
+  case IORING_OP_WRITE:
+    if(sqe->len < 0 || (uint)sqe->addr >= curproc->sz ||
+       (uint)sqe->addr+sqe->len > curproc->sz)
+      return -1;
+    if(pagein((uint)sqe->addr, sqe->len, sqe->op == IORING_OP_READ) < 0)
+      return -1;
+    if(sqe->op == IORING_OP_READ)
+      return fileread(f, sqe->addr, sqe->len);
+    return filewrite(f, sqe->addr, sqe->len);
+  case IORING_OP_OPEN:
+    if(fetchstr((uint)sqe->addr, &path) < 0)
+      return -1;
+    return openpath(path, sqe->len);
+  case IORING_OP_CLOSE:
+    curproc->ofile[sqe->fd] = 0;
+    fileclose(f);
+    return 0;
+  }
+  return -1;
+}
+
+// Carry out up to n operations queued in the calling process's I/O
+// ring (see ioring.h) with a single trap, in this kernel context.
+// Returns how many were consumed.
+int
+sys_submit(void)
+{
+  struct io_ring *r;
+  struct io_sqe sqe;
+  struct io_cqe *cqe;
+  int n, done;
+
+  if(argint(0, &n) < 0)
+    return -1;
+  if((r = (struct io_ring*)myproc()->io_ring) == 0)
+    return -1;
+
+  for(done = 0; done < n; done++){
+    if(r->sq_head == r->sq_tail || r->cq_tail - r->cq_head >= IORING_CQES)
+      break;
+    // Copy the entry so the process cannot change it under us.
+    sqe = r->sq[r->sq_head % IORING_SQES];
+    r->sq_head++;
+    cqe = &r->cq[r->cq_tail % IORING_CQES];
+    cqe->data = sqe.data;
+    cqe->res = ioring_op(&sqe);
+    r->cq_tail++;
+  }
+  return done;
+}
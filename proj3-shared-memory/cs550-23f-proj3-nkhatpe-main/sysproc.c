@@ -128,3 +128,43 @@ char* sys_get_shared_page_addr(void)
     return addr;
 }
 
+// Open a handle on the shared memory segment called name, creating it if need be (see shm.c)
+int sys_shm_open(void)
+{
+    char *name;
+    int npages;
+
+    if (argstr(0, &name) < 0 || argint(1, &npages) < 0)
+        return -1;
+    return shmopen(name, npages);
+}
+
+// Attach the segment of a handle at a chosen address; returns the address or 0
+int sys_shm_attach(void)
+{
+    int id, va;
+
+    if (argint(0, &id) < 0 || argint(1, &va) < 0)
+        return 0;
+    return (int)shmattach(id, (uint)va);
+}
+
+// Detach the shared memory segment attached at an address and close its handle
+int sys_shm_detach(void)
+{
+    int va;
+
+    if (argint(0, &va) < 0)
+        return -1;
+    return shmdetach((uint)va);
+}
+
+// Close a shared memory segment handle, detaching the segment if it is attached
+int sys_shm_close(void)
+{
+    int id;
+
+    if (argint(0, &id) < 0)
+        return -1;
+    return shmclose(id);
+}
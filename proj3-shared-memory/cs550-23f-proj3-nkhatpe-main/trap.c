@@ -78,6 +78,17 @@ trap(struct trapframe *tf)
     lapiceoi();
     break;
 
+  case T_PGFLT:
+    // A write to a page fork() left shared copy-on-write, or the first
+    // touch of the DMSMP or of heap sbrk() grew. System calls make the
+    // user buffers they use present and private first (pagein()), so a
+    // fault from the kernel that cannot be served here panics below.
+    if(myproc() && (tf->err & 2) && cowpage(myproc()->pgdir, rcr2()) == 0)
+      break;
+    if(myproc() && !(tf->err & 1) && pagefault(rcr2()) == 0)
+      break;
+    // fall through
+
   //PAGEBREAK: 13
   default:
     if(myproc() == 0 || (tf->cs&3) == 0){
@@ -103,3 +103,24 @@ memmove(void *vdst, void *vsrc, int n)
     *dst++ = *src++;
   return vdst;
 }
+
+uint64
+rdtsc(void)
+{
+  uint lo, hi;
+
+  asm volatile("rdtsc" : "=a" (lo), "=d" (hi));
+  return ((uint64)hi << 32) | lo;
+}
+
+// cycles / n. There is no 64-bit division without libgcc, so both
+// are halved until cycles fits in 32 bits.
+uint
+percycles(uint64 cycles, int n)
+{
+  while(cycles >> 32){
+    cycles >>= 1;
+    n >>= 1;
+  }
+  return n > 0 ? (uint)cycles / n : 0;
+}
@@ -31,6 +31,11 @@ int get_free_frame_cnt(void);
 // Returns:
 //   - Address of the shared memory page or NULL if the type is invalid
 char* get_shared_page_addr(int);
+int submit(int);
+int shm_open(char*, int);
+char* shm_attach(int, void*);
+int shm_detach(void*);
+int shm_close(int);
 
 // ulib.c
 int stat(char*, struct stat*);
@@ -45,3 +50,5 @@ void* memset(void*, int, uint);
 void* malloc(uint);
 void free(void*);
 int atoi(const char*);
+uint64 rdtsc(void);
+uint percycles(uint64, int);
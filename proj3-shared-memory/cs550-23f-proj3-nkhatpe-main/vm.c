@@ -68,15 +68,8 @@ mappages(pde_t *pgdir, void *va, uint size, uint pa, int perm)
   for(;;){
     if((pte = walkpgdir(pgdir, a, 1)) == 0)
       return -1;
-      
-// Check if the Page Table Entry (PTE) has the Present (PTE_P) flag set
-// If the flag is set, this indicates that the page is already present in memory
-// Uncommenting the following line would trigger a panic to catch unexpected cases of remapping
-
-
-// panic("remap");
-    //if(*pte & PTE_P)
-      //panic("remap");
+    if(*pte & PTE_P)
+      panic("remap");
     *pte = pa | perm | PTE_P;
     if(a == last)
       break;
@@ -199,30 +192,6 @@ inituvm(pde_t *pgdir, char *init, uint sz)
   memmove(mem, init, sz);
 }
 
-// Load a program segment into pgdir.  addr must be page-aligned
-// and the pages from addr to addr+sz must already be mapped.
-int
-loaduvm(pde_t *pgdir, char *addr, struct inode *ip, uint offset, uint sz)
-{
-  uint i, pa, n;
-  pte_t *pte;
-
-  if((uint) addr % PGSIZE != 0)
-    panic("loaduvm: addr must be page aligned");
-  for(i = 0; i < sz; i += PGSIZE){
-    if((pte = walkpgdir(pgdir, addr+i, 0)) == 0)
-      panic("loaduvm: address should exist");
-    pa = PTE_ADDR(*pte);
-    if(sz - i < PGSIZE)
-      n = sz - i;
-    else
-      n = PGSIZE;
-    if(readi(ip, P2V(pa), offset+i, n) != n)
-      return -1;
-  }
-  return 0;
-}
-
 // Allocate page tables and physical memory to grow process from oldsz to
 // newsz, which need not be page aligned.  Returns new size or 0 on error.
 int
@@ -231,7 +200,7 @@ allocuvm(pde_t *pgdir, uint oldsz, uint newsz)
   char *mem;
   uint a;
 
-  if(newsz >= KERNBASE)
+  if(newsz > USERTOP)
     return 0;
   if(newsz < oldsz)
     return oldsz;
@@ -255,6 +224,64 @@ allocuvm(pde_t *pgdir, uint oldsz, uint newsz)
   return newsz;
 }
 
+// Map a zeroed page at va, in user memory growproc() grew without
+// allocating. Returns -1 if memory ran out.
+int
+lazyalloc(pde_t *pgdir, uint va)
+{
+  char *mem;
+
+  if((mem = kalloc()) == 0)
+    return -1;
+  memset(mem, 0, PGSIZE);
+  if(mappages(pgdir, (char*)PGROUNDDOWN(va), PGSIZE, V2P(mem), PTE_W|PTE_U) < 0){
+    kfree(mem);
+    return -1;
+  }
+  return 0;
+}
+
+// Fault in the pages of [va, va+len) of the current process that are
+// not present yet, so that the kernel can use them while holding a
+// spinlock: reading a page of the program sleeps. If the kernel is to
+// write them, also give the process its own copy of any copy-on-write
+// page now, since running out of memory in a kernel-mode fault has no
+// way back. Returns -1 if a page cannot be had.
+int
+pagein(uint va, uint len, int write)
+{
+  pde_t *pgdir = myproc()->pgdir;
+  pte_t *pte;
+  uint a;
+
+  for(a = PGROUNDDOWN(va); a < va + len; a += PGSIZE){
+    pte = walkpgdir(pgdir, (char*)a, 0);
+    if((pte == 0 || !(*pte & PTE_P)) && pagefault(a) < 0)
+      return -1;
+    if(write && (pte = walkpgdir(pgdir, (char*)a, 0)) != 0 &&
+       (*pte & PTE_COW) && cowpage(pgdir, a) < 0)
+      return -1;
+  }
+  return 0;
+}
+
+// Count the pages of [start, end) not present in pgdir.
+int
+unmapped(pde_t *pgdir, uint start, uint end)
+{
+  pte_t *pte;
+  uint a;
+  int n;
+
+  n = 0;
+  for(a = start; a < end; a += PGSIZE){
+    pte = walkpgdir(pgdir, (char*)a, 0);
+    if(pte == 0 || !(*pte & PTE_P))
+      n++;
+  }
+  return n;
+}
+
 // Deallocate user pages to bring the process size from oldsz to
 // newsz.  oldsz and newsz need not be page-aligned, nor does newsz
 // need to be less than oldsz.  oldsz can be larger than the actual
@@ -317,8 +344,25 @@ clearpteu(pde_t *pgdir, char *uva)
   *pte &= ~PTE_U;
 }
 
+// Set PTE_SHR on a page, so that fork() shares it writable
+// with the child instead of copy-on-write.
+void
+setpteshr(pde_t *pgdir, char *uva)
+{
+  pte_t *pte;
+
+  pte = walkpgdir(pgdir, uva, 0);
+  if(pte == 0)
+    panic("setpteshr");
+  *pte |= PTE_SHR;
+}
+
 // Given a parent process's page table, create a copy
-// of it for a child.
+// of it for a child. Writable pages are not copied: parent and
+// child share the frame read-only and marked PTE_COW, and the
+// first write to it by either side copies it (see cowpage()).
+// PTE_SHR pages stay shared and writable. pgdir must be the
+// current page table.
 pde_t*
 copyuvm(pde_t *pgdir, uint sz)
 {
@@ -330,25 +374,72 @@ copyuvm(pde_t *pgdir, uint sz)
   if((d = setupkvm()) == 0)
     return 0;
   for(i = 0; i < sz; i += PGSIZE){
-    if((pte = walkpgdir(pgdir, (void *) i, 0)) == 0)
-      panic("copyuvm: pte should exist");
-    if(!(*pte & PTE_P))
-      panic("copyuvm: page not present");
+    // Pages not touched yet (the DMSMP, heap sbrk() grew) are holes;
+    // the child faults them in on its own.
+    if((pte = walkpgdir(pgdir, (void *) i, 0)) == 0 || !(*pte & PTE_P))
+      continue;
     pa = PTE_ADDR(*pte);
+    if(kref(P2V(pa)) < 0){
+      if(*pte & PTE_SHR)
+        goto bad;
+      // Too many sharers for the frame's count; copy it now.
+      if((mem = kalloc()) == 0)
+        goto bad;
+      memmove(mem, (char*)P2V(pa), PGSIZE);
+      if(mappages(d, (void*)i, PGSIZE, V2P(mem), PTE_FLAGS(*pte)) < 0){
+        kfree(mem);
+        goto bad;
+      }
+      continue;
+    }
+    if((*pte & (PTE_W|PTE_SHR)) == PTE_W)
+      *pte = (*pte & ~PTE_W) | PTE_COW;
     flags = PTE_FLAGS(*pte);
-    if((mem = kalloc()) == 0)
-      goto bad;
-    memmove(mem, (char*)P2V(pa), PGSIZE);
-    if(mappages(d, (void*)i, PGSIZE, V2P(mem), flags) < 0)
+    if(mappages(d, (void*)i, PGSIZE, pa, flags) < 0){
+      kfree(P2V(pa));
       goto bad;
+    }
   }
+  // Drop the parent's stale writable TLB entries.
+  lcr3(V2P(pgdir));
   return d;
 
 bad:
+  lcr3(V2P(pgdir));
   freevm(d);
   return 0;
 }
 
+// Give pgdir a private, writable copy of the copy-on-write page at
+// va. The last sharer of a frame takes it over without copying.
+// Returns -1 if va is not a copy-on-write page or memory ran out.
+int
+cowpage(pde_t *pgdir, uint va)
+{
+  pte_t *pte;
+  uint pa;
+  char *mem;
+
+  if(va >= KERNBASE)
+    return -1;
+  if((pte = walkpgdir(pgdir, (void*)va, 0)) == 0)
+    return -1;
+  if((*pte & (PTE_P|PTE_U|PTE_COW)) != (PTE_P|PTE_U|PTE_COW))
+    return -1;
+  pa = PTE_ADDR(*pte);
+  if(krefcnt(P2V(pa)) > 1){
+    if((mem = kalloc()) == 0)
+      return -1;
+    memmove(mem, (char*)P2V(pa), PGSIZE);
+    *pte = V2P(mem) | PTE_FLAGS(*pte);
+    kfree(P2V(pa));
+  }
+  *pte = (*pte & ~PTE_COW) | PTE_W;
+  if(myproc() && pgdir == myproc()->pgdir)
+    lcr3(V2P(pgdir));
+  return 0;
+}
+
 //PAGEBREAK!
 // Map user virtual address to kernel address.
 char*
@@ -357,7 +448,7 @@ uva2ka(pde_t *pgdir, char *uva)
   pte_t *pte;
 
   pte = walkpgdir(pgdir, uva, 0);
-  if((*pte & PTE_P) == 0)
+  if(pte == 0 || (*pte & PTE_P) == 0)
     return 0;
   if((*pte & PTE_U) == 0)
     return 0;
@@ -372,11 +463,20 @@ copyout(pde_t *pgdir, uint va, void *p, uint len)
 {
   char *buf, *pa0;
   uint n, va0;
+  pte_t *pte;
 
   buf = (char*)p;
   while(len > 0){
     va0 = (uint)PGROUNDDOWN(va);
+    // The kernel mapping bypasses PTE_W, so break copy-on-write first.
+    if((pte = walkpgdir(pgdir, (char*)va0, 0)) != 0 && (*pte & PTE_COW) &&
+       cowpage(pgdir, va0) < 0)
+      return -1;
     pa0 = uva2ka(pgdir, (char*)va0);
+    // A page of the current process not touched yet.
+    if(pa0 == 0 && (pte == 0 || !(*pte & PTE_P)) && myproc() &&
+       pgdir == myproc()->pgdir && pagefault(va0) == 0)
+      pa0 = uva2ka(pgdir, (char*)va0);
     if(pa0 == 0)
       return -1;
     n = PGSIZE - (va - va0);